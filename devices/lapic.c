@@ -0,0 +1,141 @@
+#include "devices/lapic.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* 부팅한 CPU의 local APIC. [IA32-v3a] 10장 참고.
+   외부 장치 인터럽트는 여전히 8259A PIC가 LINT0(ExtINT)로 넘겨주며,
+   여기서는 CPU마다 하나씩 있는 LAPIC 타이머를 단발 모드로만 쓴다. */
+
+/* IA32_APIC_BASE MSR. */
+#define MSR_APIC_BASE 0x1b
+#define APIC_BASE_ENABLE (1 << 11)      /* xAPIC 전역 활성화. */
+
+/* 레지스터 오프셋. */
+#define LAPIC_EOI 0x0b0                 /* End of interrupt. */
+#define LAPIC_SVR 0x0f0                 /* Spurious interrupt vector. */
+#define LAPIC_LVT_TIMER 0x320           /* LVT 타이머. */
+#define LAPIC_LVT_LINT0 0x350           /* LVT LINT0. */
+#define LAPIC_LVT_LINT1 0x360           /* LVT LINT1. */
+#define LAPIC_LVT_ERROR 0x370           /* LVT 에러. */
+#define LAPIC_TIMER_INIT 0x380          /* 타이머 초기 카운트. */
+#define LAPIC_TIMER_CUR 0x390           /* 타이머 현재 카운트. */
+#define LAPIC_TIMER_DIV 0x3e0           /* 타이머 분주 설정. */
+
+#define SVR_ENABLE 0x100                /* 소프트웨어 활성화. */
+#define LVT_MASKED 0x10000              /* 인터럽트 막음. */
+#define LVT_EXTINT 0x700                /* 전달 모드 ExtINT. */
+#define LVT_NMI 0x400                   /* 전달 모드 NMI. */
+#define TIMER_DIV_16 0x3                /* 버스 클럭 / 16. */
+
+/* 레지스터 영역의 커널 가상 주소. LAPIC이 없으면 NULL. */
+static volatile uint32_t *lapic;
+
+static intr_handler_func lapic_spurious;
+
+static uint32_t
+lapic_read (int reg) {
+	return lapic[reg / 4];
+}
+
+static void
+lapic_write (int reg, uint32_t value) {
+	lapic[reg / 4] = value;
+	(void) lapic[LAPIC_SVR / 4];    /* 쓰기가 끝날 때까지 기다린다. */
+}
+
+/* CPUID가 온칩 APIC이 있다고 하면 true. */
+static bool
+cpuid_has_apic (void) {
+	uint32_t eax = 1, ebx, ecx = 0, edx;
+
+	asm volatile ("cpuid" : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+	return (edx & (1 << 9)) != 0;
+}
+
+/* 부팅한 CPU의 LAPIC을 켜고 타이머를 멈춘 상태로 둔다.
+   LINT0은 PIC 인터럽트를 그대로 받도록 ExtINT로, LINT1은 NMI로
+   설정한다 (virtual wire 모드). LAPIC이 없으면 false. */
+bool
+lapic_init (void) {
+	uint64_t base, pa;
+	uint64_t *pte;
+
+	if (!cpuid_has_apic ())
+		return false;
+
+	base = read_msr (MSR_APIC_BASE);
+	if (!(base & APIC_BASE_ENABLE))
+		write_msr (MSR_APIC_BASE, base | APIC_BASE_ENABLE);
+	pa = base & ~(uint64_t) PGMASK;
+
+	/* 레지스터 페이지는 RAM 밖이라 paging_init()이 매핑하지 않는다.
+	   MMIO이므로 캐시를 끄고 매핑한다. */
+	pte = pml4e_walk (base_pml4, (uint64_t) ptov (pa), 1);
+	if (pte == NULL)
+		return false;
+	*pte = pa | PTE_P | PTE_W | PTE_PWT | PTE_PCD;
+	lapic = ptov (pa);
+
+	intr_register_int (LAPIC_SPURIOUS_VEC, 0, INTR_OFF, lapic_spurious,
+			"LAPIC Spurious");
+	lapic_write (LAPIC_SVR, SVR_ENABLE | LAPIC_SPURIOUS_VEC);
+	lapic_write (LAPIC_LVT_LINT0, LVT_EXTINT);
+	lapic_write (LAPIC_LVT_LINT1, LVT_NMI);
+	lapic_write (LAPIC_LVT_ERROR, LVT_MASKED);
+
+	lapic_write (LAPIC_TIMER_DIV, TIMER_DIV_16);
+	lapic_write (LAPIC_LVT_TIMER, LVT_MASKED | LAPIC_TIMER_VEC);
+	lapic_write (LAPIC_TIMER_INIT, 0);
+	return true;
+}
+
+/* lapic_init()이 성공했으면 true. */
+bool
+lapic_present (void) {
+	return lapic != NULL;
+}
+
+/* LAPIC에서 온 인터럽트 처리가 끝났음을 알린다. */
+void
+lapic_eoi (void) {
+	lapic_write (LAPIC_EOI, 0);
+}
+
+/* COUNT 카운트 뒤에 LAPIC_TIMER_VEC 인터럽트를 한 번 울린다.
+   이미 걸려 있던 것은 취소된다. COUNT는 0보다 커야 한다. */
+void
+lapic_timer_start (uint32_t count) {
+	ASSERT (lapic != NULL);
+	ASSERT (count > 0);
+
+	lapic_write (LAPIC_LVT_TIMER, LAPIC_TIMER_VEC);
+	lapic_write (LAPIC_TIMER_INIT, count);
+}
+
+/* 걸려 있는 타이머를 취소한다. */
+void
+lapic_timer_stop (void) {
+	if (lapic == NULL)
+		return;
+	lapic_write (LAPIC_LVT_TIMER, LVT_MASKED | LAPIC_TIMER_VEC);
+	lapic_write (LAPIC_TIMER_INIT, 0);
+}
+
+/* 타이머의 남은 카운트. 울렸거나 멈춰 있으면 0. */
+uint32_t
+lapic_timer_count (void) {
+	ASSERT (lapic != NULL);
+
+	return lapic_read (LAPIC_TIMER_CUR);
+}
+
+/* spurious 인터럽트는 EOI 없이 무시한다. */
+static void
+lapic_spurious (struct intr_frame *f UNUSED) {
+}
@@ -1,12 +1,17 @@
 #include "devices/timer.h"
 #include <debug.h>
 #include <inttypes.h>
+#include <rbtree.h>
 #include <round.h>
 #include <stdio.h>
+#include "devices/lapic.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/schedtrace.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "intrinsic.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -20,63 +25,143 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
-/* Number of loops per timer tick.
-   Initialized by timer_calibrate(). */
-static unsigned loops_per_tick;
+/* 8254 입력 클럭과 한 틱에 해당하는 카운트 수. */
+#define PIT_HZ 1193180
+#define PIT_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* If false (default), the PIT fires every tick.
+   If true, the idle thread reprograms it in one-shot mode up to
+   the next timer deadline.  Controlled by "-tickless". */
+bool timer_tickless;
+
+/* tickless 모드 상태.
+   oneshot_counts : 단발 모드로 걸어둔 PIT 카운트 수 (0이면 주기 모드)
+   oneshot_lead : 무장 시점에 이미 지나 있던 마지막 틱 이후의 카운트 수
+   wakeups_saved : 인터럽트 없이 따라잡은 틱 수 */
+#define ONESHOT_MAX_TICKS (0xffff / PIT_COUNT)
+static unsigned oneshot_counts;
+static unsigned oneshot_lead;
+static int64_t wakeups_saved;
+
+/* TSC 클럭소스.
+   timer_calibrate()가 PIT 틱 CALIBRATE_TICKS개 동안 TSC와 LAPIC 타이머가
+   얼마나 가는지 한 번 재고, 이후 시각은 rdtsc로 읽는다.
+   tsc_mult, lapic_mult는 32비트 고정소수점 환산 계수이며
+   ns = cycles * tsc_mult >> 32, 카운트 = ns * lapic_mult >> 32.
+   lapic_mult가 0이면 LAPIC 타이머가 없다. */
+#define NSEC_PER_SEC 1000000000LL
+#define CALIBRATE_TICKS 5
+static uint64_t tsc_boot;
+static uint64_t tsc_hz;
+static uint64_t tsc_mult;
+static uint64_t lapic_mult;
+
+/* 이보다 짧은 대기는 문맥 교환 두 번과 인터럽트 한 번보다 짧으므로
+   블록하지 않고 TSC를 보며 돈다. */
+#define SPIN_MAX_NS 20000
+
+/* 고해상도 타이머. 만료 시각(ns) 순 레드블랙 트리에 두고, 가장 이른
+   것에 맞춰 LAPIC 타이머를 단발로 건다. LAPIC 타이머가 없으면 틱마다
+   처리하므로 해상도가 한 틱이 된다. */
+static struct rbtree hrtimers;
+static int64_t hrtimer_cnt;
 
 static intr_handler_func timer_interrupt;
-static bool too_many_loops(unsigned loops);
-static void busy_wait(int64_t loops);
+static intr_handler_func hrtimer_interrupt;
+static rbtree_less_func hrtimer_less;
+static void hrtimer_run(void);
+static void hrtimer_program(void);
 static void real_time_sleep(int64_t num, int32_t denom);
 
-/* sleep_list 선언*/
-static struct list sleep_list;
-/* sleep_list 비교함수 선언*/
-static bool wakeup_tick_less(const struct list_elem *a, const struct list_elem *b, void *aux);
+/* 계층형 타이밍 휠.
+   레벨 L의 슬롯 하나는 2^(8L) 틱 구간을 담당하고, 레벨마다 256 슬롯이다.
+   레벨 0은 만료까지 256틱 미만, 레벨 1은 2^16틱 미만 ... 인 타이머를 담는다.
+   레벨 0 인덱스가 한 바퀴 돌 때마다 윗 레벨의 현재 슬롯을 아래로
+   내려보낸다(cascade). 삽입/취소 O(1), 만료 처리는 틱당 분할상환 O(1). */
+#define TW_BITS 8
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_MASK (TW_SLOTS - 1)
+#define TW_LEVELS 4
+#define TW_MAX_DELTA ((1LL << (TW_BITS * TW_LEVELS)) - 1)
+
+static struct list wheel[TW_LEVELS][TW_SLOTS];
+/* 아직 처리하지 않은 가장 이른 틱. 휠은 이 시각까지 따라와 있다. */
+static int64_t wheel_clock;
+
+static void wheel_insert(struct timer_event *ev);
+static void wheel_cascade(int level);
+static void wheel_advance(void);
+static void timer_wakeup(void *t_);
+static void timer_tick(void);
+static void pit_set_periodic(void);
+static void pit_set_oneshot(unsigned counts);
+static unsigned pit_read_count(void);
+
+/* mlfqs의 1초마다 recent_cpu 감쇠는 모든 ready 스레드를 돌므로
+   인터럽트 밖에서 wq_high의 워커가 적용한다 */
+static struct work mlfqs_work;
+static void mlfqs_decay(void *aux);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
    corresponding interrupt. */
 void timer_init(void)
 {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	pit_set_periodic();
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 
-	/* sleep_list 초기화*/
-	list_init(&sleep_list);
+	/* 타이밍 휠 초기화 */
+	for (int l = 0; l < TW_LEVELS; l++)
+		for (int i = 0; i < TW_SLOTS; i++)
+			list_init(&wheel[l][i]);
+	wheel_clock = ticks;
+
+	work_init(&mlfqs_work, mlfqs_decay, NULL);
+
+	tsc_boot = rdtsc();
+	rbtree_init(&hrtimers, hrtimer_less, NULL);
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* TSC와 LAPIC 타이머의 주파수를 PIT 틱에 맞춰 잰다.
+   틱 경계에서 시작해 CALIBRATE_TICKS 틱 동안 센다. */
 void timer_calibrate(void)
 {
-	unsigned high_bit, test_bit;
+	uint64_t tsc_start, lapic_hz = 0;
+	int64_t start;
+	bool has_lapic;
 
 	ASSERT(intr_get_level() == INTR_ON);
 	printf("Calibrating timer...  ");
 
-	/* Approximate loops_per_tick as the largest power-of-two
-	   still less than one timer tick. */
-	loops_per_tick = 1u << 10;
-	while (!too_many_loops(loops_per_tick << 1))
+	has_lapic = lapic_init();
+
+	start = ticks;
+	while (ticks == start)
+		barrier();
+	tsc_start = rdtsc();
+	if (has_lapic)
+		lapic_timer_start(UINT32_MAX);
+
+	start = ticks;
+	while (ticks - start < CALIBRATE_TICKS)
+		barrier();
+	tsc_hz = (rdtsc() - tsc_start) * TIMER_FREQ / CALIBRATE_TICKS;
+	if (has_lapic)
 	{
-		loops_per_tick <<= 1;
-		ASSERT(loops_per_tick != 0);
+		lapic_hz = (uint64_t)(UINT32_MAX - lapic_timer_count())
+				   * TIMER_FREQ / CALIBRATE_TICKS;
+		lapic_timer_stop();
 	}
 
-	/* Refine the next 8 bits of loops_per_tick. */
-	high_bit = loops_per_tick;
-	for (test_bit = high_bit >> 1; test_bit != high_bit >> 10; test_bit >>= 1)
-		if (!too_many_loops(high_bit | test_bit))
-			loops_per_tick |= test_bit;
-
-	printf("%'" PRIu64 " loops/s.\n", (uint64_t)loops_per_tick * TIMER_FREQ);
+	tsc_mult = ((uint64_t)NSEC_PER_SEC << 32) / tsc_hz;
+	if (lapic_hz > 0)
+	{
+		lapic_mult = (lapic_hz << 32) / NSEC_PER_SEC;
+		intr_register_ext(LAPIC_TIMER_VEC, hrtimer_interrupt, "LAPIC Timer");
+	}
+	printf("TSC %'" PRIu64 " Hz, LAPIC timer %'" PRIu64 " Hz.\n",
+		   tsc_hz, lapic_hz);
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -98,6 +183,20 @@ timer_elapsed(int64_t then)
 	return timer_ticks() - then;
 }
 
+/* TSC 사이클 CYCLES를 ns로 바꾼다. timer_calibrate() 전에는 0. */
+int64_t
+timer_tsc_to_ns(uint64_t cycles)
+{
+	return ((unsigned __int128)cycles * tsc_mult) >> 32;
+}
+
+/* 부팅 후 지난 시간 (ns). 단조 증가한다. */
+int64_t
+timer_ns(void)
+{
+	return timer_tsc_to_ns(rdtsc() - tsc_boot);
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 // void timer_sleep(int64_t ticks)
 // {
@@ -108,22 +207,13 @@ timer_elapsed(int64_t then)
 // 		thread_yield();
 // }
 
-static bool wakeup_tick_less(const struct list_elem *a,
-							 const struct list_elem *b, void *aux UNUSED)
-{
-	const struct thread *t1 = list_entry(a, struct thread, sleep_elem);
-	const struct thread *t2 = list_entry(b, struct thread, sleep_elem);
-
-	return t1->wakeup_tick < t2->wakeup_tick;
-}
-
 /*  busy wait 제거
 	ticks : 몇 틱이나 잘건지
 	intr_disable() : 원자적 처리를 위해 인터럽트 끄기
 	timer_ticks() : 현재 몇 틱인지
 	thread_current() : 현재 스레드 가져오기
 	start + ticks : 깨어날 시각
-	list_insert_ordered() : sleep_list에 정렬되게 추가해줌
+	timer_add() : 스레드의 sleep_timer를 타이밍 휠에 O(1)로 등록
 	thread_block() : 블락 상태로 전환 후 schedule() 호출 후 cpu 양보
 	intr_set_level(old_level) : 이전 인터럽트 상태로 복원
 */
@@ -131,16 +221,278 @@ void timer_sleep(int64_t ticks)
 {
 	ASSERT(intr_get_level() == INTR_ON);
 
+	struct thread *cur = thread_current();
 	int64_t start = timer_ticks();
 	enum intr_level old_level = intr_disable();
 
-	thread_current()->wakeup_tick = start + ticks;
-	list_insert_ordered(&sleep_list, &thread_current()->sleep_elem, wakeup_tick_less, NULL);
+	timer_event_init(&cur->sleep_timer, timer_wakeup, cur);
+	timer_add(&cur->sleep_timer, start + ticks);
 	thread_block();
 
 	intr_set_level(old_level);
 }
 
+/* sleep_timer 만료 콜백. 인터럽트 컨텍스트에서 잠든 스레드를 깨운다. */
+static void
+timer_wakeup(void *t_)
+{
+	schedtrace(SCHEDTRACE_TIMER, t_, (int)ticks);
+	thread_unblock(t_);
+}
+
+/* EV를 만료 시 FUNC(AUX)를 호출하는 타이머로 초기화한다. */
+void timer_event_init(struct timer_event *ev, timer_func *func, void *aux)
+{
+	ASSERT(ev != NULL);
+	ASSERT(func != NULL);
+
+	ev->expires = 0;
+	ev->func = func;
+	ev->aux = aux;
+	ev->pending = false;
+}
+
+/* EV를 EXPIRES 틱에 만료되도록 휠에 등록한다.
+   이미 지난 시각이면 다음 틱에 만료된다.
+   인터럽트 핸들러에서도 호출할 수 있다. */
+void timer_add(struct timer_event *ev, int64_t expires)
+{
+	enum intr_level old_level;
+
+	ASSERT(ev != NULL);
+	ASSERT(!ev->pending);
+
+	old_level = intr_disable();
+	ev->expires = expires;
+	ev->pending = true;
+	wheel_insert(ev);
+	intr_set_level(old_level);
+}
+
+/* 아직 만료되지 않은 EV를 휠에서 제거한다.
+   취소했으면 true, 이미 만료되었거나 등록되지 않았으면 false.
+   인터럽트 핸들러에서도 호출할 수 있다. */
+bool timer_cancel(struct timer_event *ev)
+{
+	enum intr_level old_level;
+	bool cancelled = false;
+
+	ASSERT(ev != NULL);
+
+	old_level = intr_disable();
+	if (ev->pending)
+	{
+		list_remove(&ev->elem);
+		ev->pending = false;
+		cancelled = true;
+	}
+	intr_set_level(old_level);
+	return cancelled;
+}
+
+/* 만료 시각 순, 같으면 먼저 넣은 것이 앞 */
+static bool
+hrtimer_less(const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+			 void *aux UNUSED)
+{
+	const struct hrtimer *a = rbtree_entry(a_, struct hrtimer, elem);
+	const struct hrtimer *b = rbtree_entry(b_, struct hrtimer, elem);
+
+	return a->expires < b->expires;
+}
+
+/* T를 만료 시 FUNC(AUX)를 호출하는 고해상도 타이머로 초기화한다. */
+void hrtimer_init(struct hrtimer *t, timer_func *func, void *aux)
+{
+	ASSERT(t != NULL);
+	ASSERT(func != NULL);
+
+	t->expires = 0;
+	t->func = func;
+	t->aux = aux;
+	t->pending = false;
+}
+
+/* T를 timer_ns()가 EXPIRES가 되는 시각에 만료되도록 등록한다.
+   이미 지난 시각이면 곧바로 인터럽트를 걸어 만료시킨다.
+   인터럽트 핸들러에서도 호출할 수 있다. */
+void hrtimer_add(struct hrtimer *t, int64_t expires)
+{
+	enum intr_level old_level;
+
+	ASSERT(t != NULL);
+	ASSERT(!t->pending);
+
+	old_level = intr_disable();
+	t->expires = expires;
+	t->pending = true;
+	rbtree_insert(&hrtimers, &t->elem);
+	if (rbtree_first(&hrtimers) == &t->elem)
+		hrtimer_program();
+	intr_set_level(old_level);
+}
+
+/* 아직 만료되지 않은 T를 취소한다.
+   취소했으면 true, 이미 만료되었거나 등록되지 않았으면 false.
+   걸어 둔 LAPIC 타이머는 그대로 두며, 울리면 다음 것으로 다시 건다. */
+bool hrtimer_cancel(struct hrtimer *t)
+{
+	enum intr_level old_level;
+	bool cancelled = false;
+
+	ASSERT(t != NULL);
+
+	old_level = intr_disable();
+	if (t->pending)
+	{
+		rbtree_remove(&hrtimers, &t->elem);
+		t->pending = false;
+		cancelled = true;
+	}
+	intr_set_level(old_level);
+	return cancelled;
+}
+
+/* 가장 이른 고해상도 타이머에 맞춰 LAPIC 타이머를 건다.
+   인터럽트가 꺼진 상태에서 호출. */
+static void
+hrtimer_program(void)
+{
+	int64_t delta;
+	uint64_t count;
+
+	if (lapic_mult == 0)
+		return;
+	if (rbtree_empty(&hrtimers))
+	{
+		lapic_timer_stop();
+		return;
+	}
+
+	delta = rbtree_entry(rbtree_first(&hrtimers), struct hrtimer, elem)->expires
+			- timer_ns();
+	if (delta < 0)
+		delta = 0;
+	count = ((unsigned __int128)delta * lapic_mult) >> 32;
+	if (count == 0)
+		count = 1;
+	else if (count > UINT32_MAX)
+		count = UINT32_MAX; /* 멀면 중간에 한 번 깨어 다시 건다 */
+	lapic_timer_start(count);
+}
+
+/* 만료된 고해상도 타이머의 콜백을 호출하고 다음 것을 건다.
+   인터럽트 컨텍스트에서 호출된다. */
+static void
+hrtimer_run(void)
+{
+	int64_t now = timer_ns();
+
+	while (!rbtree_empty(&hrtimers))
+	{
+		struct hrtimer *t = rbtree_entry(rbtree_first(&hrtimers),
+										 struct hrtimer, elem);
+
+		if (t->expires > now)
+			break;
+		rbtree_remove(&hrtimers, &t->elem);
+		t->pending = false;
+		hrtimer_cnt++;
+		t->func(t->aux);
+	}
+	hrtimer_program();
+}
+
+/* LAPIC 타이머 인터럽트 핸들러 */
+static void
+hrtimer_interrupt(struct intr_frame *args UNUSED)
+{
+	hrtimer_run();
+	if (!thread_mlfqs)
+		thread_preempt();
+	else
+		thread_preempt_edf();
+}
+
+/* 만료까지 남은 틱 수로 레벨을 고르고, 그 레벨에서 만료 시각이
+   속한 슬롯에 EV를 넣는다. 인터럽트가 꺼진 상태에서 호출. */
+static void
+wheel_insert(struct timer_event *ev)
+{
+	int64_t expires = ev->expires;
+	int64_t delta = expires - wheel_clock;
+	int level;
+
+	if (delta < 0)
+	{
+		/* 이미 지났으면 바로 다음에 처리할 슬롯으로 */
+		expires = wheel_clock;
+		delta = 0;
+	}
+	else if (delta > TW_MAX_DELTA)
+	{
+		/* 휠 범위를 넘으면 최상위 레벨 끝에 두었다가 cascade 때 재배치 */
+		expires = wheel_clock + TW_MAX_DELTA;
+		delta = TW_MAX_DELTA;
+	}
+
+	for (level = 0; level < TW_LEVELS - 1; level++)
+		if (delta < (1LL << (TW_BITS * (level + 1))))
+			break;
+
+	list_push_back(&wheel[level][(expires >> (TW_BITS * level)) & TW_MASK],
+				   &ev->elem);
+}
+
+/* LEVEL의 현재 슬롯에 있는 타이머들을 모두 아래 레벨로 다시 넣는다. */
+static void
+wheel_cascade(int level)
+{
+	struct list *slot = &wheel[level][(wheel_clock >> (TW_BITS * level)) & TW_MASK];
+
+	while (!list_empty(slot))
+		wheel_insert(list_entry(list_pop_front(slot), struct timer_event, elem));
+}
+
+/* 휠을 현재 ticks까지 진행시키며 만료된 타이머의 콜백을 호출한다.
+   인터럽트 컨텍스트에서 호출되므로 ticks를 직접 읽는다. */
+static void
+wheel_advance(void)
+{
+	struct list expired;
+
+	while (wheel_clock <= ticks)
+	{
+		int idx = wheel_clock & TW_MASK;
+		struct list *slot;
+
+		/* 레벨 0이 한 바퀴 돌았으면 윗 레벨을 차례로 내려보낸다 */
+		if (idx == 0)
+			for (int l = 1; l < TW_LEVELS; l++)
+			{
+				wheel_cascade(l);
+				if (((wheel_clock >> (TW_BITS * l)) & TW_MASK) != 0)
+					break;
+			}
+
+		/* 슬롯을 통째로 떼어낸 뒤 시계를 먼저 진행시킨다.
+		   콜백이 지난 시각으로 다시 등록해도 다음 틱 슬롯에 들어간다. */
+		slot = &wheel[0][idx];
+		list_init(&expired);
+		if (!list_empty(slot))
+			list_splice(list_end(&expired), list_begin(slot), list_end(slot));
+		wheel_clock++;
+
+		while (!list_empty(&expired))
+		{
+			struct timer_event *ev = list_entry(list_pop_front(&expired),
+												struct timer_event, elem);
+			ev->pending = false;
+			ev->func(ev->aux);
+		}
+	}
+}
+
 /* Suspends execution for approximately MS milliseconds. */
 void timer_msleep(int64_t ms)
 {
@@ -162,20 +514,168 @@ void timer_nsleep(int64_t ns)
 /* Prints timer statistics. */
 void timer_print_stats(void)
 {
-	printf("Timer: %" PRId64 " ticks\n", timer_ticks());
+	printf("Timer: %" PRId64 " ticks, %" PRId64 " high-resolution timers\n",
+		   timer_ticks(), hrtimer_cnt);
+}
+
+/* tickless 모드에서 인터럽트 없이 지나간 틱 수 */
+int64_t timer_wakeups_saved(void)
+{
+	return wakeups_saved;
+}
+
+/* idle 스레드가 hlt 직전에 인터럽트를 끈 채로 호출한다.
+   가장 가까운 타이머 만료까지 틱 인터럽트가 필요 없으면
+   PIT를 그 시각에 한 번만 울리는 단발 모드로 바꾼다.
+   PIT 카운터가 16비트라 한 번에 ONESHOT_MAX_TICKS 틱까지만 건너뛰고,
+   레벨 0이 한 바퀴 도는 cascade 지점은 넘지 않는다. */
+void timer_idle_enter(void)
+{
+	int64_t n;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (!timer_tickless || oneshot_counts != 0)
+		return;
+
+	/* LAPIC 타이머가 없으면 고해상도 타이머도 틱으로 처리한다 */
+	if (lapic_mult == 0 && !rbtree_empty(&hrtimers))
+		return;
+
+	/* 다음 cascade 지점까지, 최대 ONESHOT_MAX_TICKS 틱 */
+	n = TW_SLOTS - (wheel_clock & TW_MASK);
+	if (n > ONESHOT_MAX_TICKS)
+		n = ONESHOT_MAX_TICKS;
+
+	/* 그 안에 만료되는 타이머가 있으면 그 틱까지만 */
+	for (int64_t i = 0; i < n; i++)
+		if (!list_empty(&wheel[0][(wheel_clock + i) & TW_MASK]))
+		{
+			n = i + 1;
+			break;
+		}
+	if (n <= 1)
+		return;
+
+	/* 주기 모드 카운터는 PIT_COUNT에서 1까지 내려가므로
+	   지난 틱 이후 이미 흐른 카운트를 빼서 틱 경계에 맞춘다. */
+	oneshot_lead = PIT_COUNT - pit_read_count();
+	if (oneshot_lead >= PIT_COUNT)
+		oneshot_lead = 0;
+	pit_set_oneshot(n * PIT_COUNT - oneshot_lead);
+}
+
+/* 단발 모드가 걸린 상태에서 타이머가 아닌 외부 인터럽트가 오면
+   intr_handler()가 핸들러보다 먼저 호출한다.
+   그동안 흐른 틱만큼 ticks, idle_ticks, MLFQS 값을 따라잡고,
+   남은 틱 조각만큼 다시 단발로 걸어 틱 위상을 유지한다. */
+void timer_idle_exit(void)
+{
+	unsigned remaining, total;
+	int64_t k;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (oneshot_counts == 0)
+		return;
+
+	remaining = pit_read_count();
+	if (remaining == 0 || remaining > oneshot_counts)
+		remaining = 0; /* 이미 0에 도달해 래핑됨 */
+	total = oneshot_lead + oneshot_counts - remaining;
+
+	for (k = total / PIT_COUNT; k > 0; k--)
+	{
+		timer_tick();
+		wakeups_saved++;
+	}
+	wheel_advance();
+
+	oneshot_lead = total % PIT_COUNT;
+	pit_set_oneshot(PIT_COUNT - oneshot_lead);
+}
+
+/* PIT 채널 0을 TIMER_FREQ 주기 모드로 설정 */
+static void
+pit_set_periodic(void)
+{
+	/* 8254 input frequency divided by TIMER_FREQ, rounded to
+	   nearest. */
+	uint16_t count = PIT_COUNT;
+
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+	oneshot_counts = 0;
+}
+
+/* PIT 채널 0을 COUNTS 카운트 뒤 한 번 울리는 단발 모드로 설정 */
+static void
+pit_set_oneshot(unsigned counts)
+{
+	ASSERT(counts > 0 && counts <= 0xffff);
+
+	outb(0x43, 0x30); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb(0x40, counts & 0xff);
+	outb(0x40, counts >> 8);
+	oneshot_counts = counts;
+}
+
+/* PIT 채널 0의 현재 카운트 값을 래치해 읽는다 */
+static unsigned
+pit_read_count(void)
+{
+	unsigned lo, hi;
+
+	outb(0x43, 0x00); /* CW: counter 0, latch. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return lo | (hi << 8);
 }
 
 /* Timer interrupt handler.
 	tick++ : 시스템 전역 틱 카운트 증가
 	thread_tick() : 스레드 레벨에서 한틱 지남을 알림 -> time_slice 갱신
 	----
-	슬립 리스트에서 기상 시각 도달 스레드만 깨우기
-	sleep_list가 빈 리스트가 아니면 while 진입
-	t 에 sleep_list 가 있는 스레드 구조체 반환
-	앞에부터 순차 검사해서 현재 틱보다 작으면 다 언블락
+	wheel_advance() : 타이밍 휠을 현재 틱까지 돌려 만료된 타이머만 처리
+	깨운 스레드에 대한 선점 검사는 틱당 한 번만 수행
 */
 static void
 timer_interrupt(struct intr_frame *args UNUSED)
+{
+	/* 단발 모드가 만료된 것이면 마지막 한 틱을 제외한 나머지를
+	   따라잡고 주기 모드로 되돌린다. */
+	if (oneshot_counts != 0)
+	{
+		for (int64_t k = (oneshot_lead + oneshot_counts) / PIT_COUNT; k > 1; k--)
+		{
+			timer_tick();
+			wakeups_saved++;
+		}
+		pit_set_periodic();
+	}
+
+	timer_tick();
+
+	/* 타이밍 휠 처리 */
+	wheel_advance();
+	if (lapic_mult == 0)
+		hrtimer_run();
+
+	/* 선점 추가
+		우선순위 선점은 priority scheduler일 때만 검사하고,
+		EDF 선점은 mlfqs에서도 검사한다
+	*/
+	if (!thread_mlfqs)
+		thread_preempt();
+	else
+		thread_preempt_edf();
+}
+
+/* 한 틱 동안의 시간 기록. 타이머 인터럽트와 tickless 따라잡기에서
+   똑같이 쓰이므로 건너뛴 틱도 MLFQS 값이 틱마다 계산한 것과 같다. */
+static void
+timer_tick(void)
 {
 	ticks++;
 	thread_tick();
@@ -188,91 +688,72 @@ timer_interrupt(struct intr_frame *args UNUSED)
 		if (ticks % TIMER_FREQ == 0)
 		{
 			mlfqs_calculate_load_avg();
-			mlfqs_recalculate_recent_cpu();
+			mlfqs_next_epoch();
+			work_queue(&wq_high, &mlfqs_work);
 		}
 		if (ticks % 4 == 0)
 		{
 			mlfqs_recalculate_priority();
 		}
 	}
-
-	/*슬립 리스트 처리*/
-	while (!list_empty(&sleep_list))
-	{
-		struct thread *t = list_entry(list_front(&sleep_list),
-									  struct thread, sleep_elem);
-		if (t->wakeup_tick > timer_ticks())
-			break;
-		list_pop_front(&sleep_list);
-		thread_unblock(t);
-
-		/* 선점 추가
-			priority scheduler일 때만 선점 검사
-		*/
-		if (!thread_mlfqs)
-			thread_preempt();
-	}
 }
 
-/* Returns true if LOOPS iterations waits for more than one timer
-   tick, otherwise false. */
-static bool
-too_many_loops(unsigned loops)
+/* mlfqs_work. 이번 초의 감쇠를 스레드들에 적용한다 */
+static void
+mlfqs_decay(void *aux UNUSED)
 {
-	/* Wait for a timer tick. */
-	int64_t start = ticks;
-	while (ticks == start)
-		barrier();
+	bool done;
 
-	/* Run LOOPS loops. */
-	start = ticks;
-	busy_wait(loops);
+	/* 인터럽트는 한 배치 동안만 끄고, 배치 사이에 밀린 인터럽트를 받는다 */
+	do
+	{
+		enum intr_level old_level = intr_disable();
 
-	/* If the tick count changed, we iterated too long. */
-	barrier();
-	return start != ticks;
+		done = mlfqs_recalculate_recent_cpu();
+		intr_set_level(old_level);
+	} while (!done);
 }
 
-/* Iterates through a simple loop LOOPS times, for implementing
-   brief delays.
-
-   Marked NO_INLINE because code alignment can significantly
-   affect timings, so that if this function was inlined
-   differently in different places the results would be difficult
-   to predict. */
-static void NO_INLINE
-busy_wait(int64_t loops)
+/* 현재 스레드를 NS ns 동안 재운다. */
+static void
+hrtimer_sleep(int64_t ns)
 {
-	while (loops-- > 0)
-		barrier();
+	struct hrtimer t;
+	enum intr_level old_level = intr_disable();
+
+	hrtimer_init(&t, timer_wakeup, thread_current());
+	hrtimer_add(&t, timer_ns() + ns);
+	thread_block();
+	intr_set_level(old_level);
 }
 
-/* Sleep for approximately NUM/DENOM seconds. */
+/* Sleep for approximately NUM/DENOM seconds.
+   SPIN_MAX_NS보다 짧으면 TSC를 보며 돌고, 그보다 길면
+   고해상도 타이머를 걸고 블록한다. */
 static void
 real_time_sleep(int64_t num, int32_t denom)
 {
-	/* Convert NUM/DENOM seconds into timer ticks, rounding down.
-
-	   (NUM / DENOM) s
-	   ---------------------- = NUM * TIMER_FREQ / DENOM ticks.
-	   1 s / TIMER_FREQ ticks
-	   */
-	int64_t ticks = num * TIMER_FREQ / denom;
+	int64_t ns, start;
 
 	ASSERT(intr_get_level() == INTR_ON);
-	if (ticks > 0)
+	ASSERT(NSEC_PER_SEC % denom == 0);
+
+	ns = num * (NSEC_PER_SEC / denom);
+	if (ns <= 0)
+		return;
+	if (tsc_mult == 0)
 	{
-		/* We're waiting for at least one full timer tick.  Use
-		   timer_sleep() because it will yield the CPU to other
-		   processes. */
-		timer_sleep(ticks);
+		/* 보정 전에는 틱 단위로 올림해서 잔다 */
+		timer_sleep(DIV_ROUND_UP(ns, NSEC_PER_SEC / TIMER_FREQ));
+		return;
 	}
-	else
+
+	if (ns >= SPIN_MAX_NS)
 	{
-		/* Otherwise, use a busy-wait loop for more accurate
-		   sub-tick timing.  We scale the numerator and denominator
-		   down by 1000 to avoid the possibility of overflow. */
-		ASSERT(denom % 1000 == 0);
-		busy_wait(loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
+		hrtimer_sleep(ns);
+		return;
 	}
+	start = timer_ns();
+	while (timer_ns() - start < ns)
+		barrier();
 }
@@ -130,28 +130,24 @@ file_get_inode(struct file *file)
  * Advances FILE's position by the number of bytes read. */
 off_t file_read(struct file *file, void *buffer, off_t size)
 {
-	lock_acquire(&filesys_lock);
-
 	/* 출력디스크립터 일때 */
 	if (file == &console_out)
-	{
-		lock_release(&filesys_lock);
 		return -1;
-	}
 	/* 표준 입력 일때 */
 	else if (file->inode == NULL)
 	{
 		/* stdin 역할 */
 		for (off_t i = 0; i < size; i++)
 			((char *)buffer)[i] = input_getc();
-		lock_release(&filesys_lock);
 
 		return size;
 	}
 
+	/* filesys_lock 없이 inode의 읽기 락만 잡으므로
+	   같은 inode든 다른 inode든 여러 스레드가 함께 읽을 수 있다.
+	   FILE과 그 pos는 한 프로세스만 쓴다 */
 	off_t bytes_read = inode_read_at(file->inode, buffer, size, file->pos);
 	file->pos += bytes_read;
-	lock_release(&filesys_lock);
 
 	return bytes_read;
 }
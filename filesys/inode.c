@@ -9,6 +9,9 @@
 
 /* inode lock 추가를 위한 헤더 선언*/
 #include "threads/synch.h"
+#ifdef VM
+#include "vm/vm.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -41,8 +44,9 @@ struct inode
 	int deny_write_cnt;		/* 0: writes ok, >0: deny writes. */
 	struct inode_disk data; /* Inode content. */
 
-	/* inode lock 변수 추가*/
-	struct lock inode_lock;
+	/* inode lock 변수 추가.
+	   읽기는 여럿이 함께, 쓰기와 open_cnt/removed/deny_write_cnt 변경은 혼자 */
+	struct rwlock inode_lock;
 };
 
 /* Returns the disk sector that contains byte offset POS within
@@ -136,7 +140,7 @@ inode_open(disk_sector_t sector)
 		return NULL;
 
 	/* inode가 새로 생성되었으니 락도 초기화 */
-	lock_init(&inode->inode_lock);
+	rwlock_init(&inode->inode_lock);
 
 	/* Initialize. */
 	list_push_front(&open_inodes, &inode->elem);
@@ -154,9 +158,9 @@ inode_reopen(struct inode *inode)
 {
 	if (inode != NULL)
 	{
-		lock_acquire(&inode->inode_lock);
+		rwlock_acquire_write(&inode->inode_lock);
 		inode->open_cnt++;
-		lock_release(&inode->inode_lock);
+		rwlock_release_write(&inode->inode_lock);
 	}
 	return inode;
 }
@@ -176,13 +180,13 @@ void inode_close(struct inode *inode)
 	if (inode == NULL)
 		return;
 
-	lock_acquire(&inode->inode_lock);
+	rwlock_acquire_write(&inode->inode_lock);
 
 	/* open_cnt 감소 후, 아직 더 열려 있으면 락만 풀고 종료 */
 	inode->open_cnt--;
 	if (inode->open_cnt > 0)
 	{
-		lock_release(&inode->inode_lock);
+		rwlock_release_write(&inode->inode_lock);
 		return;
 	}
 
@@ -197,7 +201,7 @@ void inode_close(struct inode *inode)
 	list_remove(&inode->elem);
 
 	/* 락 해제 */
-	lock_release(&inode->inode_lock);
+	rwlock_release_write(&inode->inode_lock);
 
 	/* 블록 해제 */
 	if (do_remove)
@@ -214,9 +218,13 @@ void inode_close(struct inode *inode)
 void inode_remove(struct inode *inode)
 {
 	ASSERT(inode != NULL);
-	lock_acquire(&inode->inode_lock);
+#ifdef VM
+	/* 지운 inode의 페이지를 텍스트 캐시가 더 나눠 주지 않게 한다 */
+	vm_text_invalidate(inode, 0, inode_length(inode));
+#endif
+	rwlock_acquire_write(&inode->inode_lock);
 	inode->removed = true;
-	lock_release(&inode->inode_lock);
+	rwlock_release_write(&inode->inode_lock);
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -228,7 +236,7 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 	off_t bytes_read = 0;
 	uint8_t *bounce = NULL;
 
-	lock_acquire(&inode->inode_lock);
+	rwlock_acquire_read(&inode->inode_lock);
 	while (size > 0)
 	{
 		/* Disk sector to read, starting byte offset within sector. */
@@ -269,7 +277,7 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-	lock_release(&inode->inode_lock);
+	rwlock_release_read(&inode->inode_lock);
 
 	free(bounce);
 
@@ -291,7 +299,7 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
 	if (inode->deny_write_cnt)
 		return 0;
 
-	lock_acquire(&inode->inode_lock);
+	rwlock_acquire_write(&inode->inode_lock);
 	while (size > 0)
 	{
 		/* Sector to write, starting byte offset within sector. */
@@ -339,10 +347,17 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
 		offset += chunk_size;
 		bytes_written += chunk_size;
 	}
-	lock_release(&inode->inode_lock);
+	rwlock_release_write(&inode->inode_lock);
 
 	free(bounce);
 
+#ifdef VM
+	/* 쓴 범위의 옛 내용을 텍스트 캐시가 더 나눠 주지 않게 한다.
+	   쓰기가 끝난 뒤에 불러야 쓰는 도중에 읽은 내용도 캐시에 들지 않는다 */
+	if (bytes_written > 0)
+		vm_text_invalidate(inode, offset - bytes_written, bytes_written);
+#endif
+
 	return bytes_written;
 }
 
@@ -350,9 +365,9 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
    May be called at most once per inode opener. */
 void inode_deny_write(struct inode *inode)
 {
-	lock_acquire(&inode->inode_lock);
+	rwlock_acquire_write(&inode->inode_lock);
 	inode->deny_write_cnt++;
-	lock_release(&inode->inode_lock);
+	rwlock_release_write(&inode->inode_lock);
 	ASSERT(inode->deny_write_cnt <= inode->open_cnt);
 }
 
@@ -363,9 +378,9 @@ void inode_allow_write(struct inode *inode)
 {
 	ASSERT(inode->deny_write_cnt > 0);
 	ASSERT(inode->deny_write_cnt <= inode->open_cnt);
-	lock_acquire(&inode->inode_lock);
+	rwlock_acquire_write(&inode->inode_lock);
 	inode->deny_write_cnt--;
-	lock_release(&inode->inode_lock);
+	rwlock_release_write(&inode->inode_lock);
 }
 
 /* Returns the length, in bytes, of INODE's data. */
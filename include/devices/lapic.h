@@ -0,0 +1,22 @@
+#ifndef DEVICES_LAPIC_H
+#define DEVICES_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* LAPIC 타이머 인터럽트 벡터.
+   0x20...0x2f는 8259A PIC가 쓰므로 그 바로 뒤에 둔다. */
+#define LAPIC_TIMER_VEC 0x30
+
+/* LAPIC spurious 인터럽트 벡터. EOI를 보내지 않는다. */
+#define LAPIC_SPURIOUS_VEC 0xff
+
+bool lapic_init (void);
+bool lapic_present (void);
+void lapic_eoi (void);
+
+void lapic_timer_start (uint32_t count);
+void lapic_timer_stop (void);
+uint32_t lapic_timer_count (void);
+
+#endif /* devices/lapic.h */
@@ -1,23 +1,65 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
+#include <rbtree.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* 타이밍 휠에 등록되는 타이머 이벤트.
+   EXPIRES 틱이 되면 타이머 인터럽트 컨텍스트에서 FUNC(AUX)가 호출된다.
+   호출자가 구조체 메모리를 소유하므로 등록 시 할당이 없다. */
+typedef void timer_func (void *aux);
+struct timer_event {
+	int64_t expires;            /* 만료 시각 (절대 틱). */
+	timer_func *func;           /* 만료 시 호출할 콜백. */
+	void *aux;                  /* 콜백 인자. */
+	bool pending;               /* 휠에 등록되어 있는지. */
+	struct list_elem elem;      /* 휠 슬롯 리스트 연결자. */
+};
+
+/* 고해상도 타이머 이벤트.
+   timer_ns()가 EXPIRES가 되면 LAPIC 타이머 인터럽트 컨텍스트에서
+   FUNC(AUX)가 호출된다. 틱보다 짧은 마감에 쓴다. */
+struct hrtimer {
+	int64_t expires;            /* 만료 시각 (부팅 후 ns). */
+	timer_func *func;           /* 만료 시 호출할 콜백. */
+	void *aux;                  /* 콜백 인자. */
+	bool pending;               /* 등록되어 있는지. */
+	struct rbtree_elem elem;    /* 만료 순 트리 원소. */
+};
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_ns (void);
+int64_t timer_tsc_to_ns (uint64_t cycles);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+void timer_event_init (struct timer_event *, timer_func *, void *aux);
+void timer_add (struct timer_event *, int64_t expires);
+bool timer_cancel (struct timer_event *);
+
+void hrtimer_init (struct hrtimer *, timer_func *, void *aux);
+void hrtimer_add (struct hrtimer *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer *);
+
 void timer_print_stats (void);
 
+/* tickless idle. */
+extern bool timer_tickless;
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+int64_t timer_wakeups_saved (void);
+
 #endif /* devices/timer.h */
@@ -0,0 +1,19 @@
+#ifndef __LIB_CLOCK_H
+#define __LIB_CLOCK_H
+
+#include <stdint.h>
+
+/* Clocks, shared between the kernel and the clock_gettime()
+   system call. */
+
+/* Which clock clock_gettime() reads. */
+#define CLOCK_MONOTONIC 1           /* Time since boot. */
+#define CLOCK_PROCESS_CPUTIME_ID 2  /* CPU time used by the calling process. */
+
+struct timespec
+  {
+    int64_t tv_sec;             /* Seconds. */
+    int64_t tv_nsec;            /* Nanoseconds, 0 to 999,999,999. */
+  };
+
+#endif /* lib/clock.h */
@@ -0,0 +1,64 @@
+#ifndef __LIB_KERNEL_PAIRHEAP_H
+#define __LIB_KERNEL_PAIRHEAP_H
+
+/* Pairing heap.
+ *
+ * A max-heap in which the element at the top is the greatest
+ * according to the heap's comparison function.  Insertion is
+ * O(1); removing the top or an arbitrary element is amortized
+ * O(log n).  An element whose key has changed, in either
+ * direction, can be repositioned with pairheap_update().
+ *
+ * Like lists and hash tables, the heap does not use dynamic
+ * allocation.  Each structure that can be in a heap embeds a
+ * struct pairheap_elem member, and pairheap_entry() converts a
+ * pointer to that member back to the enclosing structure.  An
+ * element may be in at most one heap at a time through a given
+ * member. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct pairheap_elem {
+	struct pairheap_elem *child;    /* Leftmost child. */
+	struct pairheap_elem *next;     /* Right sibling. */
+	struct pairheap_elem *prev;     /* Left sibling, or parent if leftmost. */
+};
+
+/* Converts pointer to heap element PAIRHEAP_ELEM into a pointer
+ * to the structure that PAIRHEAP_ELEM is embedded inside.
+ * Supply the name of the outer structure STRUCT and the member
+ * name MEMBER of the heap element. */
+#define pairheap_entry(PAIRHEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) (PAIRHEAP_ELEM)                \
+		- offsetof (STRUCT, MEMBER)))
+
+/* Compares the value of two heap elements A and B, given
+ * auxiliary data AUX.  Returns true if A is less than B, or
+ * false if A is greater than or equal to B. */
+typedef bool pairheap_less_func (const struct pairheap_elem *a,
+		const struct pairheap_elem *b,
+		void *aux);
+
+/* Pairing heap. */
+struct pairheap {
+	struct pairheap_elem *root;     /* Greatest element, or NULL. */
+	size_t size;                    /* Number of elements. */
+	pairheap_less_func *less;       /* Comparison function. */
+	void *aux;                      /* Auxiliary data for `less'. */
+};
+
+void pairheap_init (struct pairheap *, pairheap_less_func *, void *aux);
+
+void pairheap_push (struct pairheap *, struct pairheap_elem *);
+struct pairheap_elem *pairheap_top (const struct pairheap *);
+struct pairheap_elem *pairheap_pop (struct pairheap *);
+void pairheap_remove (struct pairheap *, struct pairheap_elem *);
+void pairheap_update (struct pairheap *, struct pairheap_elem *);
+
+size_t pairheap_size (const struct pairheap *);
+bool pairheap_empty (const struct pairheap *);
+
+#endif /* lib/kernel/pairheap.h */
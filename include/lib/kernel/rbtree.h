@@ -0,0 +1,72 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * A balanced binary search tree kept in order by the tree's
+ * comparison function.  Insertion and removal are O(log n).
+ * The least element is cached, so finding it is O(1), and
+ * stepping to the next or previous element is amortized O(1).
+ * Elements that compare equal are kept in insertion order.
+ *
+ * Like lists and heaps, the tree does not use dynamic
+ * allocation.  Each structure that can be in a tree embeds a
+ * struct rbtree_elem member, and rbtree_entry() converts a
+ * pointer to that member back to the enclosing structure.  An
+ * element may be in at most one tree at a time through a given
+ * member.  The key of an element must not change while it is in
+ * a tree; remove it, change the key, and insert it again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tree element. */
+struct rbtree_elem {
+	struct rbtree_elem *parent;     /* Parent, or NULL for the root. */
+	struct rbtree_elem *left;       /* Lesser child. */
+	struct rbtree_elem *right;      /* Greater or equal child. */
+	bool red;                       /* Red or black? */
+};
+
+/* Converts pointer to tree element RBTREE_ELEM into a pointer
+ * to the structure that RBTREE_ELEM is embedded inside.
+ * Supply the name of the outer structure STRUCT and the member
+ * name MEMBER of the tree element. */
+#define rbtree_entry(RBTREE_ELEM, STRUCT, MEMBER)               \
+	((STRUCT *) ((uint8_t *) (RBTREE_ELEM)                  \
+		- offsetof (STRUCT, MEMBER)))
+
+/* Compares the value of two tree elements A and B, given
+ * auxiliary data AUX.  Returns true if A is less than B, or
+ * false if A is greater than or equal to B. */
+typedef bool rbtree_less_func (const struct rbtree_elem *a,
+		const struct rbtree_elem *b,
+		void *aux);
+
+/* Red-black tree. */
+struct rbtree {
+	struct rbtree_elem *root;       /* Root, or NULL. */
+	struct rbtree_elem *first;      /* Least element, or NULL. */
+	size_t size;                    /* Number of elements. */
+	rbtree_less_func *less;         /* Comparison function. */
+	void *aux;                      /* Auxiliary data for `less'. */
+};
+
+void rbtree_init (struct rbtree *, rbtree_less_func *, void *aux);
+
+void rbtree_insert (struct rbtree *, struct rbtree_elem *);
+void rbtree_remove (struct rbtree *, struct rbtree_elem *);
+struct rbtree_elem *rbtree_pop_first (struct rbtree *);
+struct rbtree_elem *rbtree_find (const struct rbtree *,
+		const struct rbtree_elem *);
+
+struct rbtree_elem *rbtree_first (const struct rbtree *);
+struct rbtree_elem *rbtree_last (const struct rbtree *);
+struct rbtree_elem *rbtree_next (const struct rbtree_elem *);
+struct rbtree_elem *rbtree_prev (const struct rbtree_elem *);
+
+size_t rbtree_size (const struct rbtree *);
+bool rbtree_empty (const struct rbtree *);
+
+#endif /* lib/kernel/rbtree.h */
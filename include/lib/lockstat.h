@@ -0,0 +1,27 @@
+#ifndef __LIB_LOCKSTAT_H
+#define __LIB_LOCKSTAT_H
+
+#include <stdint.h>
+
+/* Lock contention statistics, shared between the kernel and the
+   lockstat() system call.
+
+   Locks are grouped into classes by the place they were
+   initialized, so e.g. every inode's lock is counted under
+   "inode.c:inode->inode_lock".  All times are in TSC cycles. */
+
+#define LOCKSTAT_NAME_LEN 40    /* Bytes in a class name, with null. */
+#define LOCKSTAT_HIST_CNT 32    /* Buckets in the wait histogram. */
+
+struct lockstat
+  {
+    char name[LOCKSTAT_NAME_LEN];       /* "file.c:expression". */
+    uint64_t acquired;                  /* Successful acquisitions. */
+    uint64_t contended;                 /* Acquisitions that had to wait. */
+    uint64_t wait_total;                /* Total time spent waiting. */
+    uint64_t hold_total;                /* Total time held. */
+    uint64_t hold_max;                  /* Longest time held. */
+    uint64_t wait_hist[LOCKSTAT_HIST_CNT]; /* Waits, by floor(log2(cycles)). */
+  };
+
+#endif /* lib/lockstat.h */
@@ -0,0 +1,23 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* Resource usage, shared between the kernel and the getrusage()
+   system call.  All times are in TSC cycles. */
+
+/* Which usage getrusage() reports. */
+#define RUSAGE_SELF 0           /* The calling process. */
+#define RUSAGE_CHILDREN (-1)    /* Its children that have been waited for. */
+
+struct rusage
+  {
+    uint64_t utime;             /* Time spent in user mode. */
+    uint64_t stime;             /* Time spent in the kernel. */
+    uint64_t wtime;             /* Time spent ready, waiting for a CPU. */
+    uint64_t nvcsw;             /* Context switches made by blocking. */
+    uint64_t nivcsw;            /* Context switches made by preemption. */
+    uint64_t faults;            /* Page faults. */
+  };
+
+#endif /* lib/rusage.h */
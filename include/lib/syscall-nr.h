@@ -36,6 +36,12 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra */
+	SYS_FDLIMIT,                /* Get or set the max file descriptor. */
+	SYS_LOCKSTAT,               /* Snapshot lock contention statistics. */
+	SYS_GETRUSAGE,              /* Get CPU time and context switch counts. */
+	SYS_CLOCK_GETTIME,          /* Read a high-resolution clock. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -2,8 +2,11 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <clock.h>
 #include <debug.h>
 #include <stddef.h>
+#include <lockstat.h>
+#include <rusage.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -37,6 +40,10 @@ unsigned tell (int fd);
 void close (int fd);
 
 int dup2(int oldfd, int newfd);
+int fdlimit (int max);
+int lockstat (struct lockstat *buf, int max);
+int getrusage (int who, struct rusage *usage);
+int clock_gettime (int clock, struct timespec *ts);
 
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
@@ -0,0 +1,49 @@
+#ifndef THREADS_SCHEDTRACE_H
+#define THREADS_SCHEDTRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* 스케줄러 이벤트 종류. */
+enum schedtrace_type
+  {
+    SCHEDTRACE_SWITCH,          /* TID가 CPU를 놓고 ARG가 실행됨. */
+    SCHEDTRACE_UNBLOCK,         /* TID가 ready가 됨. ARG는 깨운 스레드. */
+    SCHEDTRACE_BLOCK,           /* TID가 잠듦. */
+    SCHEDTRACE_PREEMPT,         /* TID가 우선순위 ARG의 스레드에게 선점됨. */
+    SCHEDTRACE_TIMER,           /* 타이머 인터럽트가 TID를 깨움. */
+    SCHEDTRACE_DONATE,          /* TID의 우선순위가 기부로 ARG가 됨. */
+    SCHEDTRACE_CREATE,          /* ARG가 TID를 만듦. */
+    SCHEDTRACE_TYPE_CNT
+  };
+
+/* 트레이스 레코드 하나. 24바이트. */
+struct schedtrace_event
+  {
+    uint64_t tsc;               /* rdtsc() 시각. */
+    int32_t tid;                /* 이벤트의 대상 스레드. */
+    int32_t arg;                /* 종류별 인자. */
+    uint8_t type;               /* enum schedtrace_type. */
+    uint8_t priority;           /* 기록 당시 TID의 우선순위. */
+    uint8_t status;             /* 기록 당시 TID의 enum thread_status. */
+  };
+
+/* -schedtrace: 스케줄러 이벤트를 기록할지. */
+extern bool schedtrace_enabled;
+
+void schedtrace_init (void);
+void schedtrace_record (enum schedtrace_type, const struct thread *, int arg);
+void schedtrace_name (const struct thread *);
+void schedtrace_dump (void);
+
+/* T에 대한 TYPE 이벤트를 기록한다. 꺼져 있으면 분기 하나로 끝난다. */
+static inline void
+schedtrace (enum schedtrace_type type, const struct thread *t, int arg)
+{
+  if (schedtrace_enabled)
+    schedtrace_record (type, t, arg);
+}
+
+#endif /* threads/schedtrace.h */
@@ -2,7 +2,9 @@
 #define THREADS_SYNCH_H
 
 #include <list.h>
+#include <pairheap.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore {
@@ -19,18 +21,87 @@ void sema_self_test (void);
 /* Lock. */
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
-	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	uintptr_t owner;            /* Holder | LOCK_CONTENDED, or 0 if free. */
+	struct list waiters;        /* Threads blocked in lock_acquire(). */
+	bool tracked;               /* In holder's held_locks heap? */
+	struct pairheap donors;     /* Waiting threads, by priority. */
+	struct pairheap_elem held_elem; /* Element in holder's held_locks. */
+	struct lockstat *stat;      /* Contention statistics for its class. */
+	uint64_t acquire_tsc;       /* When acquired, if profiling. */
 };
 
-void lock_init (struct lock *);
+/* Set in lock->owner while threads may be blocked on the lock,
+   which sends lock_release() down the slow path.  Threads are
+   page-aligned, so the low bit of a holder pointer is free. */
+#define LOCK_CONTENDED ((uintptr_t) 1)
+
+/* Thread holding LOCK, or a null pointer. */
+#define lock_owner(LOCK) \
+	((struct thread *) ((LOCK)->owner & ~LOCK_CONTENDED))
+
+/* Initializes LOCK, naming it after where it was initialized so
+   that lock profiling can group locks by that place. */
+#define lock_init(LOCK) lock_init_named (LOCK, __FILE__ ":" #LOCK)
+
+void lock_init_named (struct lock *, const char *name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+/* Readers-writer lock.
+   Any number of readers, or a single writer.  A writer holds
+   WRITER for as long as it holds the rwlock, including while it
+   waits for the current readers to leave, so readers that arrive
+   after a writer queue up behind it and writers cannot be
+   starved.  A writer waiting on readers donates its priority to
+   each of them.  A thread may hold any number of different
+   rwlocks for reading at a time. */
+struct rwlock {
+	struct lock writer;         /* Held by the writer. */
+	int readers;                /* Number of readers. */
+	struct list reader_list;    /* Read holds (rwlock_hold->elem). */
+	bool draining;              /* Writer waiting for readers to leave? */
+	struct semaphore drained;   /* Upped by the last reader to leave. */
+};
+
+/* One rwlock that a thread holds for reading.  Each hold keeps
+   the priority donated by that rwlock's waiting writer, so that
+   releasing one rwlock drops only its own donation.  A thread's
+   first hold lives in struct thread; further ones are allocated
+   with malloc() while they are held. */
+struct rwlock_hold {
+	struct rwlock *rwlock;      /* Held rwlock, or null if unused. */
+	struct thread *thread;      /* Reading thread. */
+	struct list_elem elem;      /* Element in rwlock's reader_list. */
+	struct list_elem thread_elem; /* Element in thread's read_holds. */
+	int boost;                  /* Donated priority, or PRI_MIN - 1. */
+};
+
+#define rwlock_init(RW) rwlock_init_named (RW, __FILE__ ":" #RW)
+
+void rwlock_init_named (struct rwlock *, const char *name);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_held_by_current_thread (const struct rwlock *);
+
+/* Lock profiling (-lockstat).  See threads/lockstat.c. */
+struct lockstat;
+extern bool lockstat_enabled;
+struct lockstat *lockstat_class (const char *name);
+void lockstat_acquired (struct lock *, uint64_t wait_start);
+void lockstat_released (struct lock *);
+int lockstat_class_cnt (void);
+int lockstat_snapshot (struct lockstat *buf, int max);
+void lockstat_print_stats (void);
+
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct pairheap waiters;    /* Waiting threads, by priority. */
+	struct list mlfqs_waiters;  /* Same waiters, for MLFQS refresh. */
+	int mlfqs_epoch;            /* MLFQS epoch all waiters are refreshed to. */
 };
 
 void cond_init (struct condition *);
@@ -2,12 +2,19 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
 #include <list.h>
+#include <rbtree.h>
+#include <rusage.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
+#include "devices/timer.h"
 #ifdef VM
 #include "vm/vm.h"
 #endif
+#ifdef USERPROG
+#include "userprog/fdtable.h"
+#endif
 
 #include "threads/synch.h"
 
@@ -30,14 +37,19 @@ typedef int tid_t;
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63	   /* Highest priority. */
 
+/* EDF 스레드들의 밀도(runtime / min(deadline, period)) 합의 상한.
+   백만분율이며, 나머지는 일반 스레드의 몫으로 남긴다. */
+#define EDF_DENSITY_MAX 900000
+
+/* nice 값의 범위 */
+#define NICE_MIN -20
+#define NICE_MAX 20
+
 /* mlfqs 를 위한 #define 추가*/
 #define NICE_DEFAULT 0
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0
 
-/* fd를 위한 #define 추가*/
-#define MAX_FD 512
-
 /* A kernel thread or user process.
  *
  * Each thread structure is stored in its own 4 kB page.  The
@@ -113,57 +125,158 @@ struct thread
 #ifdef VM
 	/* Table for whole virtual memory owned by thread. */
 	struct supplemental_page_table spt;
+	uintptr_t user_rsp; /* 시스템 콜에 들어올 때의 유저 rsp (스택 확장 판단용) */
 #endif
 
 	/* Owned by thread.c. */
-	struct intr_frame tf; /* Information for switching */
-	unsigned magic;		  /* Detects stack overflow. */
+	uint64_t switch_rsp; /* Kernel stack pointer saved by switch_threads(). */
+	unsigned magic;		 /* Detects stack overflow. */
 
-	/* alarm을 위한 깨울 시각, 슬립 리스트 연결용 엘리먼트 추가*/
-	int64_t wakeup_tick;
-	struct list_elem sleep_elem;
+	/* alarm을 위한 타이머 이벤트 (깨울 시각은 sleep_timer.expires) */
+	struct timer_event sleep_timer;
 
 	/* donate를 위한 변수들
 		base_priority : 원래 우선순위
-		donation_list : 나한테 기부된 우선순위들
-		donation_elem : donation_list에 들어갈 list_elem
+		held_locks : 내가 가진 락들. 각 락의 최고 대기자 우선순위 순 힙
+		donation_elem : 기다리는 락의 donors 힙에 들어갈 원소
 		wating_lock : 내가 얻으려고 기다리는 락
 	*/
 	int base_priority;
-	struct list donation_list;
-	struct list_elem donation_elem;
+	struct pairheap held_locks;
+	struct pairheap_elem donation_elem;
 	struct lock *waiting_lock;
 
+	/* rwlock 읽기를 위한 변수들
+		read_holds : 읽기로 잡고 있는 rwlock들(rwlock_hold). 각각 그 rwlock의
+			reader_list 원소와 기다리는 writer에게서 기부받은 우선순위를 갖는다
+		read_hold : 첫 번째 읽기에 쓰는 기록. 그 이상은 malloc으로 할당한다
+		draining_rwlock : reader들이 빠지기를 기다리는 rwlock (writer)
+	*/
+	struct list read_holds;
+	struct rwlock_hold read_hold;
+	struct rwlock *draining_rwlock;
+
+	/* condvar 대기 중일 때 그 condvar와 대기자 힙 원소.
+		우선순위가 바뀌면 힙에서의 위치를 고치기 위해 쓴다 */
+	struct condition *waiting_cond;
+	struct pairheap_elem *cond_elem;
+
+	/* 스케줄링 클래스별 상태. 그 클래스 스레드에만 따로 할당한다
+		edf : EDF 스레드의 예약과 작업 상태. 일반 스레드는 NULL
+		cfs : CFS 스케줄러(-cfs)의 노드. -cfs가 아니면 NULL
+	*/
+	struct edf_entity *edf;
+	struct cfs_entity *cfs;
+
+	/* CPU 사용량 계정
+		usage : 이 스레드의 사용량
+		child_usage : wait()으로 거둔 자식들의 사용량 합.
+			처음 자식을 거둘 때 할당하며 그 전에는 NULL
+		acct_stamp : usage에 마지막으로 시간을 더한 시각 (rdtsc)
+		acct_user : 지금 유저 모드에서 실행 중인지
+		ready_stamp : ready가 된 시각
+	*/
+	struct rusage usage;
+	struct rusage *child_usage;
+	uint64_t acct_stamp;
+	bool acct_user;
+	uint64_t ready_stamp;
+
 	/* mlfqs를 위한 변수 추가*/
 	int nice;
 	int recent_cpu;
 
+	/* mlfqs 증분 계산을 위한 변수
+		mlfqs_epoch : recent_cpu 감쇠가 적용된 마지막 초(epoch)
+		mlfqs_dirty : 마지막 priority 계산 이후 recent_cpu가 바뀌었는지
+		dirty_elem : dirty 리스트 연결자
+		lazy_elem : block 되어 감쇠를 미뤄둔 스레드 리스트 연결자
+	*/
+	int mlfqs_epoch;
+	bool mlfqs_dirty;
+	bool mlfqs_lazy;
+	struct list_elem dirty_elem;
+	struct list_elem lazy_elem;
+
 	/* all_list의 리스트 요소*/
 	struct list_elem allelem;
 
+	/* tid로 스레드를 찾기 위한 thread_table의 요소 */
+	struct hash_elem tid_elem;
+
 	/* exit()를 위한 종료 상태 변수 추가 */
 	int exit_status;
 
 	/* process의 부모 자식 관계를 위한 변수 추가*/
 	struct list children; // struct child_status elem 들의 리스트
 	tid_t parent_tid;	  // 나의 부모를 기록
+	struct child_status *child_status; // 부모가 가진 나의 child_status
 
+#ifdef USERPROG
 	/* fd 테이블을 추가*/
-	struct file **fd_table; // fd_table 동적할당으로 변경
-	int next_fd;
+	struct fd_table fd_table; // 필요할 때만 늘어나는 fd 테이블
+#endif
 
 	/* rox를 위한 자신이 실행한 프로그램을 가짐 */
 	struct file *exec_prog;
 };
 
+/* EDF 스레드의 예약과 현재 작업 상태. 단위는 타이머 틱
+	runtime / period / deadline : 예약
+	release : 현재 작업이 릴리스된 시각
+	abs_deadline : 현재 작업의 절대 마감 시각
+	budget : 이번 주기에 남은 실행 시간
+	throttled : 예산을 다 써서 다음 주기까지 실행하지 않음
+	parked : throttled 상태로 ready가 되어 큐 밖에서 기다리는 중
+	jobs / misses : 끝낸 작업 수와 그중 마감을 넘긴 수
+	elem : edf_queue 힙 원소
+	timer : throttled 상태를 풀어 줄 다음 릴리스 타이머
+	free_elem : 스레드가 죽은 뒤 해제를 기다리는 리스트 원소
+*/
+struct edf_entity
+{
+	struct thread *thread;
+	int64_t runtime;
+	int64_t period;
+	int64_t deadline;
+	int64_t release;
+	int64_t abs_deadline;
+	int64_t budget;
+	bool throttled;
+	bool parked;
+	int64_t jobs;
+	int64_t misses;
+	struct pairheap_elem elem;
+	struct timer_event timer;
+	struct list_elem free_elem;
+};
+
+/* CFS 스케줄러를 위한 스레드의 노드
+	vruntime : 가중치로 나눈 누적 실행 시간
+	weight : nice 값에서 얻은 가중치
+	elem : cfs_queue 트리 원소
+	free_elem : 스레드가 죽은 뒤 해제를 기다리는 리스트 원소
+*/
+struct cfs_entity
+{
+	struct thread *thread;
+	int64_t vruntime;
+	int weight;
+	struct rbtree_elem elem;
+	struct list_elem free_elem;
+};
+
 /* 자식 프로세스 상태를 기록할 구조체 */
 struct child_status
 {
 	tid_t tid;			   /* 자식 스레드/프로세스 id */
+	tid_t parent_tid;	   /* 이 기록을 가진 부모의 id */
 	int exit_status;	   /* 자식이 exit() 에서 넘긴 상태 코드 */
 	bool has_exited;	   /* exit() 이 이미 호출되었는지 */
+	struct rusage usage;   /* 자식과 그 자손들의 사용량 */
 	struct semaphore sema; /* 부모가 대기(sema_down)할 세마포어 */
 	struct list_elem elem; /* 부모의 children 리스트 항목 연결자 */
+	struct hash_elem hash_elem; /* tid로 찾기 위한 status_table 요소 */
 };
 
 /* If false (default), use round-robin scheduler.
@@ -171,6 +284,10 @@ struct child_status
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the completely fair scheduler for normal threads.
+   Controlled by kernel command-line option "-cfs". */
+extern bool thread_cfs;
+
 void thread_init(void);
 void thread_start(void);
 
@@ -180,6 +297,25 @@ void thread_print_stats(void);
 typedef void thread_func(void *aux);
 tid_t thread_create(const char *name, int priority, thread_func *, void *);
 
+/* EDF 예약. 단위는 타이머 틱.
+   PERIOD마다 작업이 릴리스되고, 릴리스 후 DEADLINE 안에
+   RUNTIME만큼의 실행 시간을 보장받는다. */
+struct edf_params
+{
+	int64_t runtime;  /* 주기마다 보장받는 실행 시간. */
+	int64_t period;	  /* 작업 릴리스 간격. */
+	int64_t deadline; /* 릴리스부터 마감까지. */
+};
+
+tid_t thread_create_edf(const char *name, const struct edf_params *,
+						thread_func *, void *);
+bool thread_edf_wait(void);
+
+/* CPU 사용량 계정 */
+void thread_account_enter(void);
+void thread_account_leave(void);
+void thread_get_usage(struct rusage *);
+
 void thread_block(void);
 void thread_unblock(struct thread *);
 
@@ -203,28 +339,39 @@ void do_iret(struct intr_frame *tf);
 /*
  priority donate를 위한 함수 선언
  thread_donate_priority() : donation
+ thread_take_donations_for_lock() : lock 획득 시 남은 대기자들의 기부를 받음
  thread_remove_donations_for_lock() : lock 해제 시 해당 기부 제거
+ thread_donate_to_readers() : writer가 rwlock의 reader들에게 기부
  thread_update_prioriy() : base + donation 중 최대값으로 priority 갱신
+ thread_donor_less() : lock의 donors 힙 비교함수
 */
-void thread_donate_priority(void);
+void thread_donate_priority(struct lock *lock);
+void thread_take_donations_for_lock(struct lock *lock);
 void thread_remove_donations_for_lock(struct lock *lock);
+void thread_donate_to_readers(struct rwlock *rw);
 void thread_update_priority(void);
+bool thread_donor_less(const struct pairheap_elem *a, const struct pairheap_elem *b, void *aux);
 
-/* ready_list 비교함수 선언*/
+/* 우선순위 내림차순 비교함수 선언 (세마포어 대기열 정렬용) */
 bool thread_priority_greater(const struct list_elem *a, const struct list_elem *b, void *aux);
 
 /* 양보 시 우선순위 선점 함수 선언*/
 void thread_preempt(void);
+bool thread_preempt_edf(void);
 
 /* mlfq를 위한 함수들 선언*/
 void mlfqs_calculate_priority(struct thread *t);
 void mlfqs_calculate_recent_cpu(struct thread *t);
 void mlfqs_calculate_load_avg(void);
 void mlfqs_increment_recent_cpu(void);
-void mlfqs_recalculate_recent_cpu(void);
+void mlfqs_next_epoch(void);
+int mlfqs_current_epoch(void);
+bool mlfqs_recalculate_recent_cpu(void);
 void mlfqs_recalculate_priority(void);
+void mlfqs_refresh(struct thread *t);
 
 /* TID로 thread 구조체를 찾아서 반환, 없으면 NULL */
 struct thread *thread_by_tid(tid_t tid);
+size_t thread_cache_reclaim(void);
 
 #endif /* threads/thread.h */
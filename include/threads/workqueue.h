@@ -0,0 +1,57 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "devices/timer.h"
+
+/* 작업 항목이 실행할 함수. 워커 스레드에서 인터럽트를 켠 채로 불린다. */
+typedef void work_func (void *aux);
+
+/* 작업 항목.
+   호출자가 메모리를 소유하므로 큐에 넣을 때 할당이 없다.
+   실행이 시작되기 전까지 pending이며, pending인 항목은 다시 넣어도
+   한 번만 실행된다. 실행 중에 자기 자신을 다시 넣을 수 있다. */
+struct work
+  {
+    work_func *func;            /* 실행할 함수. */
+    void *aux;                  /* FUNC의 인자. */
+    bool pending;               /* 큐에 있거나 지연 타이머를 기다리는 중. */
+    bool queued;                /* 큐의 items에 들어 있음. */
+    struct workqueue *wq;       /* pending일 때 들어갈 큐. */
+    struct list_elem elem;      /* 큐의 items 리스트 원소. */
+    struct timer_event timer;   /* work_queue_delayed()의 타이머. */
+  };
+
+/* 워크큐. 전용 워커 스레드 하나가 들어온 순서대로 항목을 실행한다.
+   워커의 우선순위가 큐의 우선순위다. */
+struct workqueue
+  {
+    const char *name;           /* 워커 스레드 이름. */
+    int priority;               /* 워커 스레드 우선순위. */
+    struct list items;          /* 실행을 기다리는 항목, FIFO. */
+    struct semaphore avail;     /* items에 넣을 때마다 up. */
+    int64_t done_cnt;           /* 실행한 항목 수. */
+  };
+
+/* 시스템 워크큐. 우선순위 PRI_MAX, PRI_DEFAULT, PRI_MIN.
+   인터럽트에서 미룬 작업처럼 늦으면 안 되는 일은 wq_high에,
+   쓰기 저장이나 회수처럼 한가할 때 해도 되는 일은 wq_low에 넣는다. */
+extern struct workqueue wq_high;
+extern struct workqueue wq_default;
+extern struct workqueue wq_low;
+
+void workqueue_init (void);
+bool workqueue_create (struct workqueue *, const char *name, int priority);
+void workqueue_flush (struct workqueue *);
+
+void work_init (struct work *, work_func *, void *aux);
+bool work_queue (struct workqueue *, struct work *);
+bool work_queue_delayed (struct workqueue *, struct work *, int64_t ticks);
+bool work_cancel (struct work *);
+
+void workqueue_print_stats (void);
+
+#endif /* threads/workqueue.h */
@@ -0,0 +1,43 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct file;
+
+/* struct thread 안에 바로 들어 있는 fd 슬롯 수.
+   대부분의 프로세스는 이 안에서 끝나 따로 할당하지 않는다. */
+#define FD_INLINE_CNT 8
+
+/* 프로세스가 열 수 있는 fd 개수의 기본 상한. */
+#define FD_MAX_DEFAULT 512
+
+/* fdlimit()으로 올릴 수 있는 상한의 최댓값. */
+#define FD_MAX_LIMIT 65536
+
+/* 프로세스의 파일 디스크립터 테이블.
+   슬롯 배열은 처음에 inline_files를 쓰다가 필요할 때 두 배씩 늘리고,
+   사용 중인 슬롯은 used 비트맵으로 관리해 빈 fd를 바로 찾는다. */
+struct fd_table
+  {
+    struct file **files;        /* 슬롯 배열. */
+    uint64_t *used;             /* 사용 중인 슬롯 비트맵. */
+    int cap;                    /* files의 슬롯 수. */
+    int max;                    /* 열 수 있는 fd의 상한. */
+    int cnt;                    /* 열려 있는 fd 수. */
+    struct file *inline_files[FD_INLINE_CNT];
+    uint64_t inline_used;
+  };
+
+void fd_table_init (struct fd_table *);
+bool fd_table_copy (struct fd_table *dst, struct fd_table *src);
+void fd_table_destroy (struct fd_table *);
+bool fd_table_set_max (struct fd_table *, int max);
+
+int fd_alloc (struct fd_table *, struct file *);
+bool fd_install (struct fd_table *, int fd, struct file *);
+struct file *fd_get (struct fd_table *, int fd);
+struct file *fd_remove (struct fd_table *, int fd);
+
+#endif /* userprog/fdtable.h */
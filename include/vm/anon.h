@@ -2,12 +2,27 @@
 #define VM_ANON_H
 #include "vm/vm.h"
 struct page;
+struct frame;
 enum vm_type;
 
+/* 익명 페이지. 내보내지면 스왑 슬롯 하나에 내용을 둔다.
+   fork로 나눠 쓰던 페이지는 슬롯도 나눠 쓴다. */
 struct anon_page {
+	size_t slot;            /* 스왑 슬롯, 프레임에 있으면 SWAP_NONE. */
+	bool readahead;         /* 미리 읽기로 올라오는 중인가? */
 };
 
+/* 스왑 슬롯이 없음. */
+#define SWAP_NONE ((size_t) -1)
+
+/* 연속된 스왑 슬롯에 한 번에 내보내는 최대 페이지 수. */
+#define SWAP_CLUSTER 8
+
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+bool anon_swappable (void);
+bool anon_swap_out_cluster (struct frame **frames, size_t cnt);
+void anon_share_slot (struct page *dst, const struct page *src);
+void anon_print_stats (void);
 
 #endif
@@ -6,7 +6,14 @@
 struct page;
 enum vm_type;
 
+/* 파일에서 내용을 읽어 오는 페이지.
+   mmap 페이지의 데이터이자, 실행 파일 세그먼트와 mmap 페이지가
+   uninit일 때 지연 로딩에 넘기는 AUX이기도 하다. */
 struct file_page {
+	struct file *file;      /* 읽어 올 파일. 페이지마다 참조를 하나 가진다. */
+	off_t ofs;              /* 파일 안의 오프셋. */
+	size_t read_bytes;      /* 파일에서 읽을 바이트 수. 나머지는 0. */
+	size_t page_cnt;        /* mmap의 첫 페이지면 매핑의 페이지 수, 아니면 0. */
 };
 
 void vm_file_init (void);
@@ -14,4 +21,9 @@ bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+struct file_page *file_page_dup (const struct file_page *);
+void file_page_free (struct file_page *);
+struct file_page *page_file_info (struct page *page);
+bool lazy_load_file (struct page *page, void *aux);
+void file_backed_adopt (struct page *page);
 #endif
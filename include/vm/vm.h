@@ -1,6 +1,9 @@
 #ifndef VM_VM_H
 #define VM_VM_H
 #include <stdbool.h>
+#include <stdint.h>
+#include <hash.h>
+#include <list.h>
 #include "threads/palloc.h"
 
 enum vm_type {
@@ -46,6 +49,11 @@ struct page {
 	struct frame *frame;   /* Back reference for frame */
 
 	/* Your implementation */
+	struct thread *owner;           /* 이 페이지를 가진 프로세스. */
+	bool writable;                  /* 유저가 쓸 수 있는가? */
+	bool zero;                      /* 공유 영 페이지에 매핑되어 있는가? */
+	struct hash_elem spt_elem;      /* supplemental_page_table의 원소. */
+	struct list_elem rmap_elem;     /* 프레임의 rmap 원소. */
 
 	/* Per-type data are binded into the union.
 	 * Each function automatically detects the current union */
@@ -60,9 +68,23 @@ struct page {
 };
 
 /* The representation of "frame" */
+/* 유저 풀의 물리 페이지 하나. 모든 프레임은 전역 프레임 테이블에 있고
+   clock 알고리즘이 그 리스트를 돌며 내보낼 프레임을 고른다.
+   pin_cnt가 0이 아닌 프레임은 내보내지 않는다. 입출력 중이거나
+   시스템 콜이 유저 버퍼로 쓰고 있는 프레임이 그렇다.
+   fork 뒤에는 여러 프로세스의 페이지가 한 프레임을 읽기 전용으로
+   나눠 쓰므로(copy-on-write) 프레임을 쓰는 페이지를 rmap에 모두 둔다.
+   읽기 전용 파일 페이지를 담은 프레임은 (inode, 오프셋)으로 텍스트
+   캐시에 들어가 같은 파일을 매핑하는 모든 프로세스가 나눠 쓴다. */
 struct frame {
 	void *kva;
-	struct page *page;
+	struct list rmap;               /* 이 프레임을 매핑한 페이지들. */
+	int ref_cnt;                    /* rmap의 길이. */
+	int pin_cnt;                    /* 고정한 횟수. */
+	struct list_elem elem;          /* 프레임 테이블 원소. */
+	struct inode *text_inode;       /* 텍스트 캐시 키, 캐시에 없으면 NULL. */
+	off_t text_ofs;                 /* 텍스트 캐시 키, 파일 안의 오프셋. */
+	struct hash_elem text_elem;     /* 텍스트 캐시 원소. */
 };
 
 /* The function table for page operations.
@@ -84,7 +106,9 @@ struct page_operations {
 /* Representation of current process's memory space.
  * We don't want to force you to obey any specific design for this struct.
  * All designs up to you for this. */
+/* 가상 주소 순이 필요 없으므로 페이지 주소를 키로 하는 해시 테이블이다. */
 struct supplemental_page_table {
+	struct hash pages;
 };
 
 #include "threads/thread.h"
@@ -109,4 +133,12 @@ void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
 enum vm_type page_get_type (struct page *page);
 
+bool vm_unmap_page (struct page *page);
+bool vm_stack_access (const void *addr, uintptr_t rsp);
+bool vm_prefetch_page (struct page *page);
+bool vm_pin_buffer (const void *uaddr, size_t size, bool write);
+void vm_unpin_buffer (const void *uaddr, size_t size);
+void vm_text_invalidate (struct inode *inode, off_t offset, off_t size);
+void vm_print_stats (void);
+
 #endif  /* VM_VM_H */
@@ -0,0 +1,155 @@
+/* Pairing heap.
+
+   See pairheap.h for basic information.
+
+   Each element points to its leftmost child and to its right
+   sibling.  Its `prev' points to its left sibling or, for the
+   leftmost child, to its parent, which lets an element be cut
+   out of the middle of the heap in O(1). */
+
+#include "pairheap.h"
+#include "../debug.h"
+
+/* Makes the lesser of roots A and B the leftmost child of the
+   greater and returns the greater. */
+static struct pairheap_elem *
+meld (struct pairheap *h, struct pairheap_elem *a, struct pairheap_elem *b) {
+	if (h->less (a, b, h->aux)) {
+		struct pairheap_elem *t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	return a;
+}
+
+/* Melds the sibling list starting at FIRST into a single tree
+   and returns its root, or a null pointer if FIRST is null.
+   Uses the standard two passes: meld adjacent pairs left to
+   right, then meld the pairs into one tree right to left. */
+static struct pairheap_elem *
+merge_pairs (struct pairheap *h, struct pairheap_elem *first) {
+	struct pairheap_elem *pairs = NULL;     /* Reversed, linked by `next'. */
+	struct pairheap_elem *root = NULL;
+
+	while (first != NULL) {
+		struct pairheap_elem *a = first;
+		struct pairheap_elem *b = first->next;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL) {
+			b->next = b->prev = NULL;
+			a = meld (h, a, b);
+		}
+		a->next = pairs;
+		pairs = a;
+	}
+
+	while (pairs != NULL) {
+		struct pairheap_elem *next = pairs->next;
+
+		pairs->next = NULL;
+		root = root != NULL ? meld (h, root, pairs) : pairs;
+		pairs = next;
+	}
+	return root;
+}
+
+/* Initializes H as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void
+pairheap_init (struct pairheap *h, pairheap_less_func *less, void *aux) {
+	ASSERT (h != NULL);
+	ASSERT (less != NULL);
+
+	h->root = NULL;
+	h->size = 0;
+	h->less = less;
+	h->aux = aux;
+}
+
+/* Inserts E into H. */
+void
+pairheap_push (struct pairheap *h, struct pairheap_elem *e) {
+	ASSERT (h != NULL);
+	ASSERT (e != NULL);
+
+	e->child = e->next = e->prev = NULL;
+	h->root = h->root != NULL ? meld (h, h->root, e) : e;
+	h->size++;
+}
+
+/* Returns the greatest element in H, or a null pointer if H is
+   empty. */
+struct pairheap_elem *
+pairheap_top (const struct pairheap *h) {
+	return h->root;
+}
+
+/* Removes the greatest element from H and returns it.  H must
+   not be empty. */
+struct pairheap_elem *
+pairheap_pop (struct pairheap *h) {
+	struct pairheap_elem *top = h->root;
+
+	ASSERT (top != NULL);
+
+	h->root = merge_pairs (h, top->child);
+	h->size--;
+	top->child = NULL;
+	return top;
+}
+
+/* Removes E, which must be in H, from H. */
+void
+pairheap_remove (struct pairheap *h, struct pairheap_elem *e) {
+	struct pairheap_elem *sub;
+
+	ASSERT (h != NULL);
+	ASSERT (e != NULL);
+
+	if (e == h->root) {
+		pairheap_pop (h);
+		return;
+	}
+
+	/* Cut E's subtree out of its parent's child list. */
+	if (e->prev->child == e)
+		e->prev->child = e->next;
+	else
+		e->prev->next = e->next;
+	if (e->next != NULL)
+		e->next->prev = e->prev;
+
+	sub = merge_pairs (h, e->child);
+	if (sub != NULL)
+		h->root = meld (h, h->root, sub);
+	h->size--;
+	e->child = e->next = e->prev = NULL;
+}
+
+/* Restores the heap order of H after the key of E, which must be
+   in H, has changed in either direction. */
+void
+pairheap_update (struct pairheap *h, struct pairheap_elem *e) {
+	pairheap_remove (h, e);
+	pairheap_push (h, e);
+}
+
+/* Returns the number of elements in H. */
+size_t
+pairheap_size (const struct pairheap *h) {
+	return h->size;
+}
+
+/* Returns true if H is empty, false otherwise. */
+bool
+pairheap_empty (const struct pairheap *h) {
+	return h->root == NULL;
+}
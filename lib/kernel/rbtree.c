@@ -0,0 +1,379 @@
+/* Red-black tree.
+
+   See rbtree.h for basic information.
+
+   This is the classic algorithm from Cormen, Leiserson, Rivest
+   and Stein, "Introduction to Algorithms", except that missing
+   children are null pointers rather than a shared black sentinel
+   node, so the removal fix-up keeps track of the parent of the
+   position it is fixing separately.  A null child counts as
+   black.
+
+   Every path from an element down to a null child passes through
+   the same number of black elements, and no red element has a
+   red child, so the tree is never more than 2 lg (n + 1) deep. */
+
+#include "rbtree.h"
+#include "../debug.h"
+
+/* Returns true if E is a red element, false if it is black or
+   null. */
+static inline bool
+is_red (const struct rbtree_elem *e) {
+	return e != NULL && e->red;
+}
+
+/* Returns the least element in the subtree rooted at E. */
+static struct rbtree_elem *
+subtree_first (struct rbtree_elem *e) {
+	while (e->left != NULL)
+		e = e->left;
+	return e;
+}
+
+/* Returns the greatest element in the subtree rooted at E. */
+static struct rbtree_elem *
+subtree_last (struct rbtree_elem *e) {
+	while (e->right != NULL)
+		e = e->right;
+	return e;
+}
+
+/* Makes NEW take OLD's place as a child of OLD's parent, or as
+   the root of T.  NEW may be null.  OLD's own links are left
+   alone. */
+static void
+replace_child (struct rbtree *t, struct rbtree_elem *old,
+		struct rbtree_elem *new) {
+	struct rbtree_elem *parent = old->parent;
+
+	if (parent == NULL)
+		t->root = new;
+	else if (parent->left == old)
+		parent->left = new;
+	else
+		parent->right = new;
+	if (new != NULL)
+		new->parent = parent;
+}
+
+/* Rotates the subtree rooted at E to the left, so that E's right
+   child takes its place and E becomes that child's left child. */
+static void
+rotate_left (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *r = e->right;
+
+	e->right = r->left;
+	if (r->left != NULL)
+		r->left->parent = e;
+	replace_child (t, e, r);
+	r->left = e;
+	e->parent = r;
+}
+
+/* Rotates the subtree rooted at E to the right, so that E's left
+   child takes its place and E becomes that child's right child. */
+static void
+rotate_right (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *l = e->left;
+
+	e->left = l->right;
+	if (l->right != NULL)
+		l->right->parent = e;
+	replace_child (t, e, l);
+	l->right = e;
+	e->parent = l;
+}
+
+/* Restores the red-black properties of T after red element E
+   has been linked in as a leaf. */
+static void
+insert_fixup (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *parent;
+
+	while ((parent = e->parent) != NULL && parent->red) {
+		/* A red parent is never the root, so GRAND exists. */
+		struct rbtree_elem *grand = parent->parent;
+
+		if (parent == grand->left) {
+			struct rbtree_elem *uncle = grand->right;
+
+			if (is_red (uncle)) {
+				/* Push the red up and continue from GRAND. */
+				parent->red = uncle->red = false;
+				grand->red = true;
+				e = grand;
+				continue;
+			}
+			if (e == parent->right) {
+				rotate_left (t, parent);
+				e = parent;
+				parent = e->parent;
+			}
+			parent->red = false;
+			grand->red = true;
+			rotate_right (t, grand);
+		} else {
+			struct rbtree_elem *uncle = grand->left;
+
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grand->red = true;
+				e = grand;
+				continue;
+			}
+			if (e == parent->left) {
+				rotate_right (t, parent);
+				e = parent;
+				parent = e->parent;
+			}
+			parent->red = false;
+			grand->red = true;
+			rotate_left (t, grand);
+		}
+	}
+	t->root->red = false;
+}
+
+/* Restores the red-black properties of T after a black element
+   has been unlinked.  E, which may be null, is the element that
+   took its place, and PARENT is E's parent.  Paths through E are
+   one black element short. */
+static void
+remove_fixup (struct rbtree *t, struct rbtree_elem *e,
+		struct rbtree_elem *parent) {
+	while (e != t->root && !is_red (e)) {
+		/* Paths through the other side have at least one black
+		   element more, so SIBLING exists. */
+		if (e == parent->left) {
+			struct rbtree_elem *sibling = parent->right;
+
+			if (sibling->red) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_left (t, parent);
+				sibling = parent->right;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				/* Move the shortage up to PARENT. */
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->right)) {
+				sibling->left->red = false;
+				sibling->red = true;
+				rotate_right (t, sibling);
+				sibling = parent->right;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->right->red = false;
+			rotate_left (t, parent);
+		} else {
+			struct rbtree_elem *sibling = parent->left;
+
+			if (sibling->red) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_right (t, parent);
+				sibling = parent->left;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->left)) {
+				sibling->right->red = false;
+				sibling->red = true;
+				rotate_left (t, sibling);
+				sibling = parent->left;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->left->red = false;
+			rotate_right (t, parent);
+		}
+		e = t->root;
+		break;
+	}
+	if (e != NULL)
+		e->red = false;
+}
+
+/* Initializes T as an empty tree ordered by LESS, given
+   auxiliary data AUX. */
+void
+rbtree_init (struct rbtree *t, rbtree_less_func *less, void *aux) {
+	ASSERT (t != NULL);
+	ASSERT (less != NULL);
+
+	t->root = NULL;
+	t->first = NULL;
+	t->size = 0;
+	t->less = less;
+	t->aux = aux;
+}
+
+/* Inserts E into T, after any elements equal to E. */
+void
+rbtree_insert (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *parent = NULL;
+	struct rbtree_elem **link = &t->root;
+	bool leftmost = true;
+
+	ASSERT (t != NULL);
+	ASSERT (e != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		if (t->less (e, parent, t->aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+
+	e->parent = parent;
+	e->left = e->right = NULL;
+	e->red = true;
+	*link = e;
+	if (leftmost)
+		t->first = e;
+	t->size++;
+	insert_fixup (t, e);
+}
+
+/* Removes E, which must be in T, from T. */
+void
+rbtree_remove (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *child, *parent;
+	bool black_removed;
+
+	ASSERT (t != NULL);
+	ASSERT (e != NULL);
+	ASSERT (t->size > 0);
+
+	if (t->first == e)
+		t->first = rbtree_next (e);
+
+	if (e->left == NULL || e->right == NULL) {
+		/* E has at most one child, which takes its place. */
+		child = e->left != NULL ? e->left : e->right;
+		parent = e->parent;
+		black_removed = !e->red;
+		replace_child (t, e, child);
+	} else {
+		/* E's successor, which has no left child, takes its
+		   place and color, and the successor's right child takes
+		   the successor's place. */
+		struct rbtree_elem *succ = subtree_first (e->right);
+
+		child = succ->right;
+		black_removed = !succ->red;
+		if (succ->parent == e)
+			parent = succ;
+		else {
+			parent = succ->parent;
+			replace_child (t, succ, child);
+			succ->right = e->right;
+			succ->right->parent = succ;
+		}
+		replace_child (t, e, succ);
+		succ->left = e->left;
+		succ->left->parent = succ;
+		succ->red = e->red;
+	}
+	t->size--;
+
+	if (black_removed)
+		remove_fixup (t, child, parent);
+	e->parent = e->left = e->right = NULL;
+}
+
+/* Removes the least element from T and returns it.  T must not
+   be empty. */
+struct rbtree_elem *
+rbtree_pop_first (struct rbtree *t) {
+	struct rbtree_elem *first = t->first;
+
+	ASSERT (first != NULL);
+
+	rbtree_remove (t, first);
+	return first;
+}
+
+/* Returns the first element in T that is equal to KEY, or a null
+   pointer if there is none.  KEY need not be in T. */
+struct rbtree_elem *
+rbtree_find (const struct rbtree *t, const struct rbtree_elem *key) {
+	struct rbtree_elem *e = t->root;
+	struct rbtree_elem *found = NULL;
+
+	/* Find the least element not less than KEY. */
+	while (e != NULL) {
+		if (t->less (e, key, t->aux))
+			e = e->right;
+		else {
+			found = e;
+			e = e->left;
+		}
+	}
+	return found != NULL && !t->less (key, found, t->aux) ? found : NULL;
+}
+
+/* Returns the least element in T, or a null pointer if T is
+   empty. */
+struct rbtree_elem *
+rbtree_first (const struct rbtree *t) {
+	return t->first;
+}
+
+/* Returns the greatest element in T, or a null pointer if T is
+   empty. */
+struct rbtree_elem *
+rbtree_last (const struct rbtree *t) {
+	return t->root != NULL ? subtree_last (t->root) : NULL;
+}
+
+/* Returns the element that follows E in its tree, or a null
+   pointer if E is the greatest element. */
+struct rbtree_elem *
+rbtree_next (const struct rbtree_elem *e) {
+	ASSERT (e != NULL);
+
+	if (e->right != NULL)
+		return subtree_first (e->right);
+	while (e->parent != NULL && e == e->parent->right)
+		e = e->parent;
+	return e->parent;
+}
+
+/* Returns the element that precedes E in its tree, or a null
+   pointer if E is the least element. */
+struct rbtree_elem *
+rbtree_prev (const struct rbtree_elem *e) {
+	ASSERT (e != NULL);
+
+	if (e->left != NULL)
+		return subtree_last (e->left);
+	while (e->parent != NULL && e == e->parent->left)
+		e = e->parent;
+	return e->parent;
+}
+
+/* Returns the number of elements in T. */
+size_t
+rbtree_size (const struct rbtree *t) {
+	return t->size;
+}
+
+/* Returns true if T is empty, false otherwise. */
+bool
+rbtree_empty (const struct rbtree *t) {
+	return t->root == NULL;
+}
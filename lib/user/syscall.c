@@ -145,6 +145,26 @@ dup2 (int oldfd, int newfd){
 	return syscall2 (SYS_DUP2, oldfd, newfd);
 }
 
+int
+fdlimit (int max) {
+	return syscall1 (SYS_FDLIMIT, max);
+}
+
+int
+lockstat (struct lockstat *buf, int max) {
+	return syscall2 (SYS_LOCKSTAT, buf, max);
+}
+
+int
+getrusage (int who, struct rusage *usage) {
+	return syscall2 (SYS_GETRUSAGE, who, usage);
+}
+
+int
+clock_gettime (int clock, struct timespec *ts) {
+	return syscall2 (SYS_CLOCK_GETTIME, clock, ts);
+}
+
 void *
 mmap (void *addr, size_t length, int writable, int fd, off_t offset) {
 	return (void *) syscall5 (SYS_MMAP, addr, length, writable, fd, offset);
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-cancel) begin
+(alarm-cancel) Registering 10000 timer events over 700 ticks.
+(alarm-cancel) Every other event is cancelled before it expires.
+(alarm-cancel) All events fired on their deadline tick.
+(alarm-cancel) All 32 sleepers woke up on time.
+(alarm-cancel) PASS
+(alarm-cancel) end
+EOF
+pass;
@@ -0,0 +1,173 @@
+/* Registers 10,000 timer events with pseudo-random deadlines
+   spread over several hundred ticks, so that many of them start
+   out in the upper levels of the timing wheel and have to be
+   cascaded down before they fire.  A few dozen real threads sleep
+   alongside them.  Verifies that every event fires exactly once,
+   on exactly the tick it was registered for, and that every
+   sleeping thread wakes up no earlier than it asked to.
+
+   alarm-cancel does the same but cancels every other event
+   before it expires and verifies that none of those fire. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of timer events registered. */
+#define EVENT_CNT 10000
+
+/* Number of sleeping threads created alongside the events. */
+#define SLEEPER_CNT 32
+
+/* Longest deadline, in ticks.  Longer than one revolution of
+   the lowest wheel level, so cascading is exercised. */
+#define MAX_DELAY 700
+
+struct wheel_event
+  {
+    struct timer_event ev;      /* Registered timer. */
+    int64_t fired;              /* Tick on which it fired. */
+    int fire_cnt;               /* Number of times it fired. */
+  };
+
+struct sleeper
+  {
+    int64_t wakeup;             /* Requested wake-up tick. */
+    bool early;                 /* Woke up before WAKEUP? */
+    struct semaphore *done;     /* Upped when finished. */
+  };
+
+static void test_wheel (bool cancel);
+static void expire (void *);
+static void sleeper (void *);
+
+void
+test_alarm_stress (void)
+{
+  test_wheel (false);
+}
+
+void
+test_alarm_cancel (void)
+{
+  test_wheel (true);
+}
+
+/* Deterministic pseudo-random delay in [1, MAX_DELAY]. */
+static int
+next_delay (unsigned *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return 1 + (*seed >> 16) % MAX_DELAY;
+}
+
+static void
+test_wheel (bool cancel)
+{
+  struct wheel_event *events;
+  struct sleeper sleepers[SLEEPER_CNT];
+  struct semaphore done;
+  unsigned seed = 1;
+  int64_t start;
+  int fired = 0, cancelled = 0;
+  int i;
+
+  msg ("Registering %d timer events over %d ticks.", EVENT_CNT, MAX_DELAY);
+  if (cancel)
+    msg ("Every other event is cancelled before it expires.");
+
+  events = malloc (sizeof *events * EVENT_CNT);
+  if (events == NULL)
+    PANIC ("couldn't allocate memory for test");
+
+  start = timer_ticks ();
+  for (i = 0; i < EVENT_CNT; i++)
+    {
+      struct wheel_event *e = &events[i];
+      e->fired = -1;
+      e->fire_cnt = 0;
+      timer_event_init (&e->ev, expire, e);
+      timer_add (&e->ev, start + next_delay (&seed));
+    }
+
+  sema_init (&done, 0);
+  for (i = 0; i < SLEEPER_CNT; i++)
+    {
+      struct sleeper *s = &sleepers[i];
+      char name[16];
+
+      s->wakeup = start + next_delay (&seed);
+      s->early = false;
+      s->done = &done;
+      snprintf (name, sizeof name, "sleeper %d", i);
+      thread_create (name, PRI_DEFAULT, sleeper, s);
+    }
+
+  if (cancel)
+    {
+      for (i = 0; i < EVENT_CNT; i += 2)
+        {
+          if (timer_cancel (&events[i].ev))
+            cancelled++;
+          else if (events[i].ev.expires > timer_ticks ())
+            fail ("event %d could not be cancelled", i);
+        }
+    }
+
+  timer_sleep (MAX_DELAY + 10);
+  for (i = 0; i < SLEEPER_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < EVENT_CNT; i++)
+    {
+      struct wheel_event *e = &events[i];
+
+      if (e->fire_cnt > 1)
+        fail ("event %d fired %d times", i, e->fire_cnt);
+      if (e->ev.pending)
+        fail ("event %d still pending after its deadline", i);
+      if (e->fire_cnt == 1)
+        {
+          if (e->fired != e->ev.expires)
+            fail ("event %d fired on tick %lld instead of %lld", i,
+                  e->fired - start, e->ev.expires - start);
+          fired++;
+        }
+    }
+  if (fired + cancelled != EVENT_CNT)
+    fail ("%d events fired and %d were cancelled, out of %d",
+          fired, cancelled, EVENT_CNT);
+
+  for (i = 0; i < SLEEPER_CNT; i++)
+    if (sleepers[i].early)
+      fail ("sleeper %d woke up early", i);
+
+  msg ("All events fired on their deadline tick.");
+  msg ("All %d sleepers woke up on time.", SLEEPER_CNT);
+  free (events);
+  pass ();
+}
+
+/* Timer callback.  Runs in the timer interrupt. */
+static void
+expire (void *e_)
+{
+  struct wheel_event *e = e_;
+
+  e->fired = timer_ticks ();
+  e->fire_cnt++;
+}
+
+/* Sleeper thread. */
+static void
+sleeper (void *s_)
+{
+  struct sleeper *s = s_;
+
+  timer_sleep (s->wakeup - timer_ticks ());
+  s->early = timer_ticks () < s->wakeup;
+  sema_up (s->done);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-stress) begin
+(alarm-stress) Registering 10000 timer events over 700 ticks.
+(alarm-stress) All events fired on their deadline tick.
+(alarm-stress) All 32 sleepers woke up on time.
+(alarm-stress) PASS
+(alarm-stress) end
+EOF
+pass;
@@ -0,0 +1,110 @@
+/* Measures how closely the completely fair scheduler divides the
+   CPU according to nice values.
+
+   Four CPU-bound threads with nice 0, 0, 5 and 10 spin for 20
+   seconds, counting the timer ticks during which they ran.  Each
+   thread's share of the ticks should match its share of the
+   total weight, which is 41.1%, 41.1%, 13.4% and 4.4%, within
+   TOLERANCE percentage points.  Run with -cfs. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of spinning threads. */
+#define THREAD_CNT 4
+
+/* Allowed difference between the measured and the expected
+   share, in tenths of a percentage point. */
+#define TOLERANCE 30
+
+/* Nice values of the threads. */
+static const int nices[THREAD_CNT] = { 0, 0, 5, 10 };
+
+/* Weights the kernel assigns to the nice values above. */
+static const int weights[THREAD_CNT] = { 1024, 1024, 335, 110 };
+
+struct thread_info
+  {
+    int64_t start_time;         /* Common start of the test. */
+    int tick_count;             /* Ticks during which it ran. */
+    int nice;                   /* Nice value. */
+  };
+
+static thread_func load_thread;
+
+void
+test_cfs_fair (void)
+{
+  struct thread_info info[THREAD_CNT];
+  int64_t start_time;
+  int total_ticks = 0, total_weight = 0;
+  int i;
+
+  /* This test requires the CFS. */
+  ASSERT (thread_cfs);
+
+  msg ("Starting %d threads with nice 0, 0, 5 and 10.", THREAD_CNT);
+  start_time = timer_ticks ();
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tick_count = 0;
+      ti->nice = nices[i];
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+    }
+
+  msg ("Sleeping 22 seconds to let threads run, please wait...");
+  timer_sleep (22 * TIMER_FREQ);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      total_ticks += info[i].tick_count;
+      total_weight += weights[i];
+    }
+  if (total_ticks == 0)
+    fail ("threads did not run");
+
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      int share = info[i].tick_count * 1000 / total_ticks;
+      int expected = weights[i] * 1000 / total_weight;
+
+      printf ("cfs-fair: thread %d (nice %d): %d ticks, %d.%d%% "
+              "(expected %d.%d%%)\n", i, info[i].nice, info[i].tick_count,
+              share / 10, share % 10, expected / 10, expected % 10);
+      if (share < expected - TOLERANCE || share > expected + TOLERANCE)
+        fail ("thread %d got %d.%d%% of the CPU instead of %d.%d%%",
+              i, share / 10, share % 10, expected / 10, expected % 10);
+    }
+  msg ("All shares within %d%% of the nice weights.", TOLERANCE / 10);
+  pass ();
+}
+
+/* Sets its nice value, waits one second for the others to do the
+   same, then spins for 20 seconds counting ticks. */
+static void
+load_thread (void *ti_)
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 1 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 20 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_nice (ti->nice);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time)
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
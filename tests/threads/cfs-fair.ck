@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# Tick counts vary from run to run, so don't compare them.
+@output = grep (!/^cfs-fair: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(cfs-fair) begin
+(cfs-fair) Starting 4 threads with nice 0, 0, 5 and 10.
+(cfs-fair) Sleeping 22 seconds to let threads run, please wait...
+(cfs-fair) All shares within 3% of the nice weights.
+(cfs-fair) PASS
+(cfs-fair) end
+EOF
+pass;
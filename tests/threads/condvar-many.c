@@ -0,0 +1,97 @@
+/* Puts WAITER_CNT threads of mixed priorities to sleep on a
+   single condition variable, then wakes them all with one
+   cond_broadcast().  Reports the number of TSC cycles the
+   broadcast took and verifies that the waiters were woken, and
+   so ran, in order of decreasing priority.
+
+   The cycle count is printed for information only. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Number of waiting threads. */
+#define WAITER_CNT 1000
+
+/* Waiter priorities lie in [PRI_MIN + 1, PRI_MIN + PRI_SPAN]. */
+#define PRI_SPAN 30
+
+static struct lock lock;
+static struct condition cond;
+static int waiting;             /* Waiters that reached cond_wait(). */
+static int *wake_order;         /* Priorities in the order woken. */
+static int woken;
+
+static thread_func waiter;
+
+void
+test_condvar_many (void)
+{
+  uint64_t start, cycles;
+  unsigned seed = 1;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  wake_order = malloc (sizeof *wake_order * WAITER_CNT);
+  if (wake_order == NULL)
+    PANIC ("couldn't allocate memory for test");
+
+  lock_init (&lock);
+  cond_init (&cond);
+  waiting = woken = 0;
+
+  msg ("Putting %d threads to sleep on one condition variable.",
+       WAITER_CNT);
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      char name[16];
+
+      seed = seed * 1103515245 + 12345;
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, PRI_MIN + 1 + (seed >> 16) % PRI_SPAN,
+                     waiter, NULL);
+    }
+
+  /* Let every waiter run up to cond_wait(). */
+  thread_set_priority (PRI_MIN);
+  if (waiting != WAITER_CNT)
+    fail ("only %d of %d waiters are waiting", waiting, WAITER_CNT);
+
+  /* Broadcast without being preempted, then let them all run. */
+  thread_set_priority (PRI_MAX);
+  lock_acquire (&lock);
+  start = rdtsc ();
+  cond_broadcast (&cond, &lock);
+  cycles = rdtsc () - start;
+  lock_release (&lock);
+  thread_set_priority (PRI_MIN);
+
+  if (woken != WAITER_CNT)
+    fail ("only %d of %d waiters woke up", woken, WAITER_CNT);
+  for (i = 1; i < WAITER_CNT; i++)
+    if (wake_order[i] > wake_order[i - 1])
+      fail ("waiter with priority %d woke after one with priority %d",
+            wake_order[i], wake_order[i - 1]);
+
+  printf ("condvar-many: broadcast to %d waiters took %llu cycles\n",
+          WAITER_CNT, cycles);
+  msg ("All waiters woke up in priority order.");
+  free (wake_order);
+  pass ();
+}
+
+static void
+waiter (void *aux UNUSED)
+{
+  lock_acquire (&lock);
+  waiting++;
+  cond_wait (&cond, &lock);
+  wake_order[woken++] = thread_get_priority ();
+  lock_release (&lock);
+}
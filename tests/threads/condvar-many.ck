@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# The cycle count varies from run to run, so don't compare it.
+@output = grep (!/^condvar-many: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(condvar-many) begin
+(condvar-many) Putting 1000 threads to sleep on one condition variable.
+(condvar-many) All waiters woke up in priority order.
+(condvar-many) PASS
+(condvar-many) end
+EOF
+pass;
@@ -0,0 +1,113 @@
+/* Admits three EDF threads whose reservations add up to 60% of
+   the CPU and checks that a reservation that would push the total
+   past the admission bound is rejected.
+
+   Each EDF thread then runs 10 periodic jobs, each of which spins
+   for one tick less than its reserved runtime, while two
+   CPU-bound normal threads (one at PRI_DEFAULT, one at PRI_MAX)
+   compete for the CPU.  EDF threads run ahead of normal threads
+   and in deadline order among themselves, so no job may miss its
+   deadline. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of EDF threads. */
+#define EDF_CNT 3
+
+/* Jobs each EDF thread runs. */
+#define JOB_CNT 10
+
+struct edf_task
+  {
+    struct edf_params params;   /* Reservation. */
+    int misses;                 /* Jobs that missed their deadline. */
+  };
+
+static struct edf_task tasks[EDF_CNT] =
+  {
+    { { 2, 10, 10 }, 0 },
+    { { 3, 15, 15 }, 0 },
+    { { 4, 20, 20 }, 0 },
+  };
+
+static struct semaphore done;
+static int finished;
+static volatile bool stop;
+
+static thread_func edf_task;
+static thread_func hog;
+
+void
+test_edf_mixed (void)
+{
+  struct edf_params greedy = { 5, 10, 10 };
+  int i, misses = 0;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  msg ("Admitting %d EDF threads with 60%% total density.", EDF_CNT);
+  for (i = 0; i < EDF_CNT; i++)
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "edf %d", i);
+      if (thread_create_edf (name, &tasks[i].params, edf_task, &tasks[i])
+          == TID_ERROR)
+        fail ("admissible reservation %d was rejected", i);
+    }
+  if (thread_create_edf ("greedy", &greedy, edf_task, NULL) != TID_ERROR)
+    fail ("reservation exceeding the bound was admitted");
+  msg ("Reservation that would exceed the bound was rejected.");
+
+  msg ("Running %d jobs each alongside 2 CPU-bound threads.", JOB_CNT);
+  thread_create ("hog default", PRI_DEFAULT, hog, NULL);
+  thread_create ("hog max", PRI_MAX, hog, NULL);
+  sema_down (&done);
+
+  for (i = 0; i < EDF_CNT; i++)
+    misses += tasks[i].misses;
+  msg ("%d jobs finished, %d deadline misses.", EDF_CNT * JOB_CNT, misses);
+  if (misses != 0)
+    fail ("EDF threads missed %d deadlines", misses);
+  pass ();
+}
+
+/* Periodic EDF thread. */
+static void
+edf_task (void *task_)
+{
+  struct edf_task *task = task_;
+  int i;
+
+  for (i = 0; i < JOB_CNT; i++)
+    {
+      int64_t end = timer_ticks () + task->params.runtime - 1;
+
+      while (timer_ticks () < end)
+        continue;
+      if (!thread_edf_wait ())
+        task->misses++;
+    }
+
+  /* The last one stops the hogs and wakes up the main thread. */
+  if (__atomic_add_fetch (&finished, 1, __ATOMIC_SEQ_CST) == EDF_CNT)
+    {
+      stop = true;
+      sema_up (&done);
+    }
+}
+
+/* CPU-bound normal thread. */
+static void
+hog (void *aux UNUSED)
+{
+  while (!stop)
+    continue;
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-mixed) begin
+(edf-mixed) Admitting 3 EDF threads with 60% total density.
+(edf-mixed) Reservation that would exceed the bound was rejected.
+(edf-mixed) Running 10 jobs each alongside 2 CPU-bound threads.
+(edf-mixed) 30 jobs finished, 0 deadline misses.
+(edf-mixed) PASS
+(edf-mixed) end
+EOF
+pass;
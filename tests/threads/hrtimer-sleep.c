@@ -0,0 +1,92 @@
+/* Checks that sub-millisecond sleeps are accurate and do not
+   burn the CPU.
+
+   The main thread sleeps SLEEP_CNT times each for 100, 250 and
+   500 microseconds with timer_usleep(), measuring each sleep
+   with timer_ns().  No sleep may end early, and on average a
+   sleep may end no more than MAX_LATENESS microseconds late,
+   which is a small fraction of a 10 ms timer tick.
+
+   Meanwhile a lower-priority thread spins, counting loops.  It
+   can only run while the main thread is blocked, so if it makes
+   progress during the sleeps, they did not busy-wait. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of sleeps of each length. */
+#define SLEEP_CNT 20
+
+/* Allowed mean lateness of a sleep, in microseconds. */
+#define MAX_LATENESS 1000
+
+/* Sleep lengths, in microseconds. */
+static const int64_t lengths[] = { 100, 250, 500 };
+#define LENGTH_CNT (sizeof lengths / sizeof *lengths)
+
+static volatile int64_t spin_cnt;
+static volatile bool done;
+static struct semaphore spinner_done;
+
+static thread_func spinner;
+
+void
+test_hrtimer_sleep (void)
+{
+  size_t i;
+  int j;
+
+  /* This test does not work with the MLFQS or the CFS. */
+  ASSERT (!thread_mlfqs && !thread_cfs);
+
+  sema_init (&spinner_done, 0);
+  thread_create ("spinner", PRI_DEFAULT - 1, spinner, NULL);
+
+  for (i = 0; i < LENGTH_CNT; i++)
+    {
+      int64_t length = lengths[i] * 1000;
+      int64_t lateness = 0;
+      int64_t spun = spin_cnt;
+
+      for (j = 0; j < SLEEP_CNT; j++)
+        {
+          int64_t start = timer_ns ();
+          int64_t elapsed;
+
+          timer_usleep (lengths[i]);
+          elapsed = timer_ns () - start;
+          if (elapsed < length)
+            fail ("%lld us sleep ended after %lld ns",
+                  lengths[i], elapsed);
+          lateness += elapsed - length;
+        }
+      lateness /= SLEEP_CNT;
+      spun = spin_cnt - spun;
+      printf ("hrtimer-sleep: %lld us: mean lateness %lld ns, "
+              "%lld loops spun\n", lengths[i], lateness, spun);
+
+      if (lateness > MAX_LATENESS * 1000)
+        fail ("%lld us sleeps ended %lld ns late on average",
+              lengths[i], lateness);
+      if (spun == 0)
+        fail ("%lld us sleeps did not let a lower-priority thread run",
+              lengths[i]);
+      msg ("%lld us sleeps are accurate and yield the CPU.", lengths[i]);
+    }
+
+  done = true;
+  sema_down (&spinner_done);
+  pass ();
+}
+
+static void
+spinner (void *aux UNUSED)
+{
+  while (!done)
+    spin_cnt++;
+  sema_up (&spinner_done);
+}
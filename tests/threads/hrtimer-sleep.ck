@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# Timings vary from run to run, so don't compare them.
+@output = grep (!/^hrtimer-sleep: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(hrtimer-sleep) begin
+(hrtimer-sleep) 100 us sleeps are accurate and yield the CPU.
+(hrtimer-sleep) 250 us sleeps are accurate and yield the CPU.
+(hrtimer-sleep) 500 us sleeps are accurate and yield the CPU.
+(hrtimer-sleep) PASS
+(hrtimer-sleep) end
+EOF
+pass;
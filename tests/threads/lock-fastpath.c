@@ -0,0 +1,78 @@
+/* Measures the cost of an uncontended lock_acquire() and
+   lock_release() pair, which takes the compare-and-swap fast
+   path, against a sema_down() and sema_up() pair on a binary
+   semaphore, which is what every lock operation used to go
+   through.  Reports the average number of TSC cycles per pair
+   for each.
+
+   Then has a higher-priority thread block on the lock, to check
+   that a lock taken on the fast path still receives the waiter's
+   donation and hands the lock over on release.
+
+   The cycle counts are printed for information only. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Number of acquire/release pairs timed. */
+#define PAIR_CNT 100000
+
+static thread_func waiter;
+
+void
+test_lock_fastpath (void)
+{
+  struct lock lock;
+  struct semaphore sema;
+  uint64_t start, lock_cycles, sema_cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  sema_init (&sema, 1);
+
+  msg ("Timing %d uncontended acquire/release pairs.", PAIR_CNT);
+  start = rdtsc ();
+  for (i = 0; i < PAIR_CNT; i++)
+    {
+      lock_acquire (&lock);
+      lock_release (&lock);
+    }
+  lock_cycles = rdtsc () - start;
+
+  start = rdtsc ();
+  for (i = 0; i < PAIR_CNT; i++)
+    {
+      sema_down (&sema);
+      sema_up (&sema);
+    }
+  sema_cycles = rdtsc () - start;
+
+  printf ("lock-fastpath: lock %llu cycles per pair, "
+          "semaphore %llu cycles per pair\n",
+          lock_cycles / PAIR_CNT, sema_cycles / PAIR_CNT);
+
+  lock_acquire (&lock);
+  thread_create ("waiter", PRI_DEFAULT + 1, waiter, &lock);
+  msg ("Main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 1, thread_get_priority ());
+  lock_release (&lock);
+  msg ("Main finishing with priority %d.", thread_get_priority ());
+  pass ();
+}
+
+static void
+waiter (void *lock_)
+{
+  struct lock *lock = lock_;
+
+  lock_acquire (lock);
+  msg ("Waiter got the lock.");
+  lock_release (lock);
+}
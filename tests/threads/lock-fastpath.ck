@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# The cycle counts vary from run to run, so don't compare them.
+@output = grep (!/^lock-fastpath: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(lock-fastpath) begin
+(lock-fastpath) Timing 100000 uncontended acquire/release pairs.
+(lock-fastpath) Main should have priority 32.  Actual priority: 32.
+(lock-fastpath) Waiter got the lock.
+(lock-fastpath) Main finishing with priority 31.
+(lock-fastpath) PASS
+(lock-fastpath) end
+EOF
+pass;
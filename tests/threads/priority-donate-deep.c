@@ -0,0 +1,86 @@
+/* Builds a donation chain much deeper than the nested-donation
+   tests.  The main thread, at PRI_MIN, holds lock 0.  Each of
+   CHAIN_DEPTH threads, created in order of increasing priority,
+   acquires its own lock and then blocks on the lock held by the
+   previous thread, so every new thread's priority has to travel
+   the whole chain down to the main thread.
+
+   When the main thread releases lock 0, the chain unwinds from
+   the highest-priority thread down, and the main thread must end
+   up back at its base priority. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define CHAIN_DEPTH 30
+
+struct link
+  {
+    struct lock *mine;          /* Lock acquired first. */
+    struct lock *next;          /* Lock held by previous link. */
+  };
+
+static thread_func link_thread_func;
+
+static int finish_order[CHAIN_DEPTH + 1];
+static int finish_cnt;
+
+/* Too large for the main thread's kernel stack. */
+static struct lock locks[CHAIN_DEPTH + 1];
+static struct link links[CHAIN_DEPTH + 1];
+
+void
+test_priority_donate_deep (void)
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_set_priority (PRI_MIN);
+  for (i = 0; i <= CHAIN_DEPTH; i++)
+    lock_init (&locks[i]);
+  lock_acquire (&locks[0]);
+
+  msg ("Building a donation chain %d threads deep.", CHAIN_DEPTH);
+  for (i = 1; i <= CHAIN_DEPTH; i++)
+    {
+      char name[16];
+      int priority = PRI_MIN + i;
+
+      links[i].mine = &locks[i];
+      links[i].next = &locks[i - 1];
+      snprintf (name, sizeof name, "link %d", i);
+      thread_create (name, priority, link_thread_func, &links[i]);
+      if (thread_get_priority () != priority)
+        fail ("after link %d, main has priority %d instead of %d",
+              i, thread_get_priority (), priority);
+    }
+  msg ("Main received the donation of every link.");
+
+  finish_cnt = 0;
+  lock_release (&locks[0]);
+
+  if (finish_cnt != CHAIN_DEPTH)
+    fail ("only %d of %d links finished", finish_cnt, CHAIN_DEPTH);
+  for (i = 0; i < CHAIN_DEPTH; i++)
+    if (finish_order[i] != CHAIN_DEPTH - i)
+      fail ("link %d finished in position %d", finish_order[i], i);
+  msg ("Links finished from the top of the chain down.");
+  msg ("Main finishing with priority %d.", thread_get_priority ());
+}
+
+static void
+link_thread_func (void *link_)
+{
+  struct link *link = link_;
+
+  lock_acquire (link->mine);
+  lock_acquire (link->next);
+  lock_release (link->next);
+  lock_release (link->mine);
+  finish_order[finish_cnt++] = thread_get_priority () - PRI_MIN;
+}
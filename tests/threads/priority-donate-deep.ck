@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-deep) begin
+(priority-donate-deep) Building a donation chain 30 threads deep.
+(priority-donate-deep) Main received the donation of every link.
+(priority-donate-deep) Links finished from the top of the chain down.
+(priority-donate-deep) Main finishing with priority 0.
+(priority-donate-deep) end
+EOF
+pass;
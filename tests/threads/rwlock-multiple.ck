@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-multiple) begin
+(rwlock-multiple) Main thread should have priority 32.  Actual priority: 32.
+(rwlock-multiple) Main thread should have priority 33.  Actual priority: 33.
+(rwlock-multiple) Thread b acquired rwlock b for writing.
+(rwlock-multiple) Thread b finished.
+(rwlock-multiple) Thread b should have just finished.
+(rwlock-multiple) Main thread should have priority 32.  Actual priority: 32.
+(rwlock-multiple) Thread a acquired rwlock a for writing.
+(rwlock-multiple) Thread a finished.
+(rwlock-multiple) Thread a should have just finished.
+(rwlock-multiple) Main thread should have priority 31.  Actual priority: 31.
+(rwlock-multiple) end
+EOF
+pass;
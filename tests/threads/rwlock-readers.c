@@ -0,0 +1,135 @@
+/* Has 8 threads hold a readers-writer lock for reading, each
+   for 10 ticks, and checks that they hold it at the same time:
+   all of them should be done in far less than the 80 ticks it
+   takes 8 writers to do the same thing one after another.
+
+   Then, with the main thread holding the lock for reading, a
+   higher-priority writer blocks waiting for it and donates its
+   priority to the main thread.  A reader with even higher
+   priority arrives next; it must queue behind the writer rather
+   than join the main thread, and its donation must reach the
+   main thread through the writer.
+
+   The tick counts are printed for information only. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of threads holding the lock in the timed runs. */
+#define HOLDER_CNT 8
+
+/* Ticks each of them holds the lock for. */
+#define HOLD_TICKS 10
+
+struct holder
+  {
+    struct rwlock *rw;          /* Lock to hold. */
+    bool write;                 /* Hold it for writing? */
+    struct semaphore *done;     /* Upped when finished. */
+  };
+
+static int64_t timed_run (struct rwlock *, bool write);
+static thread_func holder;
+static thread_func writer;
+static thread_func reader;
+
+void
+test_rwlock_readers (void)
+{
+  struct rwlock rw;
+  int64_t read_ticks, write_ticks;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rw);
+
+  msg ("%d threads each hold the lock for %d ticks.",
+       HOLDER_CNT, HOLD_TICKS);
+  read_ticks = timed_run (&rw, false);
+  write_ticks = timed_run (&rw, true);
+  printf ("rwlock-readers: readers took %lld ticks, writers %lld ticks\n",
+          read_ticks, write_ticks);
+  if (read_ticks >= HOLDER_CNT * HOLD_TICKS / 2)
+    fail ("readers took %lld ticks, so they did not share the lock",
+          read_ticks);
+  if (write_ticks < HOLDER_CNT * HOLD_TICKS)
+    fail ("writers took %lld ticks, so they shared the lock", write_ticks);
+  msg ("Readers shared the lock and writers did not.");
+
+  rwlock_acquire_read (&rw);
+  thread_create ("writer", PRI_DEFAULT + 5, writer, &rw);
+  msg ("Main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 5, thread_get_priority ());
+  thread_create ("reader", PRI_DEFAULT + 9, reader, &rw);
+  msg ("Main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 9, thread_get_priority ());
+  rwlock_release_read (&rw);
+  msg ("Main finishing with priority %d.", thread_get_priority ());
+  pass ();
+}
+
+/* Starts HOLDER_CNT threads that each hold RW for HOLD_TICKS,
+   for writing if WRITE is true, and returns how many ticks
+   pass until all of them are done. */
+static int64_t
+timed_run (struct rwlock *rw, bool write)
+{
+  struct holder h;
+  struct semaphore done;
+  int64_t start;
+  int i;
+
+  sema_init (&done, 0);
+  h.rw = rw;
+  h.write = write;
+  h.done = &done;
+
+  start = timer_ticks ();
+  for (i = 0; i < HOLDER_CNT; i++)
+    thread_create (write ? "writer" : "reader", PRI_DEFAULT, holder, &h);
+  for (i = 0; i < HOLDER_CNT; i++)
+    sema_down (&done);
+  return timer_elapsed (start);
+}
+
+static void
+holder (void *h_)
+{
+  struct holder *h = h_;
+
+  if (h->write)
+    rwlock_acquire_write (h->rw);
+  else
+    rwlock_acquire_read (h->rw);
+  timer_sleep (HOLD_TICKS);
+  if (h->write)
+    rwlock_release_write (h->rw);
+  else
+    rwlock_release_read (h->rw);
+  sema_up (h->done);
+}
+
+static void
+writer (void *rw_)
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_acquire_write (rw);
+  msg ("Writer got the lock.");
+  rwlock_release_write (rw);
+}
+
+static void
+reader (void *rw_)
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_acquire_read (rw);
+  msg ("Reader got the lock after the writer.");
+  rwlock_release_read (rw);
+}
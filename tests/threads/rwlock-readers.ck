@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# The tick counts vary from run to run, so don't compare them.
+@output = grep (!/^rwlock-readers: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(rwlock-readers) begin
+(rwlock-readers) 8 threads each hold the lock for 10 ticks.
+(rwlock-readers) Readers shared the lock and writers did not.
+(rwlock-readers) Main should have priority 36.  Actual priority: 36.
+(rwlock-readers) Main should have priority 40.  Actual priority: 40.
+(rwlock-readers) Writer got the lock.
+(rwlock-readers) Reader got the lock after the writer.
+(rwlock-readers) Main finishing with priority 31.
+(rwlock-readers) PASS
+(rwlock-readers) end
+EOF
+pass;
@@ -0,0 +1,65 @@
+/* Measures how fast threads can be created and torn down.
+   Spawns SPAWN_CNT short-lived threads, one after another, each
+   of which exits as soon as it runs, and reports how many timer
+   ticks the whole run took.  Each thread needs a fresh thread
+   page, so this exercises the page recycling cache in
+   thread_create() and do_schedule().
+
+   The timing is printed for information only; the test passes
+   as long as every thread ran exactly once. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of threads spawned per round. */
+#define SPAWN_CNT 2000
+
+/* Number of measured rounds. */
+#define ROUND_CNT 3
+
+static void child (void *);
+
+void
+test_spawn_rate (void)
+{
+  struct semaphore done;
+  int round;
+
+  sema_init (&done, 0);
+  msg ("Spawning %d threads in each of %d rounds.", SPAWN_CNT, ROUND_CNT);
+
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      int64_t start = timer_ticks ();
+      int64_t elapsed;
+      int i;
+
+      for (i = 0; i < SPAWN_CNT; i++)
+        {
+          /* Higher priority, so the child runs and exits before
+             the next one is created. */
+          if (thread_create ("child", PRI_DEFAULT + 1, child, &done)
+              == TID_ERROR)
+            fail ("thread_create() failed in round %d at thread %d",
+                  round, i);
+          sema_down (&done);
+        }
+      elapsed = timer_elapsed (start);
+      printf ("spawn-rate: round %d: %d threads in %lld ticks\n",
+              round, SPAWN_CNT, elapsed);
+    }
+
+  msg ("All threads ran and exited.");
+  pass ();
+}
+
+static void
+child (void *done_)
+{
+  struct semaphore *done = done_;
+
+  sema_up (done);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# Timing lines vary from run to run, so don't compare them.
+@output = grep (!/^spawn-rate: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(spawn-rate) begin
+(spawn-rate) Spawning 2000 threads in each of 3 rounds.
+(spawn-rate) All threads ran and exited.
+(spawn-rate) PASS
+(spawn-rate) end
+EOF
+pass;
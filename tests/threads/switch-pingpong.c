@@ -0,0 +1,77 @@
+/* Measures the cost of a kernel-to-kernel context switch.
+   The main thread and a partner thread of the same priority hand
+   control back and forth through a pair of semaphores, so every
+   sema_up() is followed by exactly one thread switch.  Reports
+   the average number of TSC cycles per switch.
+
+   The cycle count is printed for information only; the test
+   passes as long as every hand-off happened in order. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Number of round trips; each one is two switches. */
+#define ROUND_CNT 10000
+
+struct pingpong
+  {
+    struct semaphore ping;      /* Upped by main, downed by partner. */
+    struct semaphore pong;      /* Upped by partner, downed by main. */
+    struct semaphore done;      /* Upped when partner is finished. */
+    int rounds;                 /* Round trips seen by partner. */
+  };
+
+static void partner (void *);
+
+void
+test_switch_pingpong (void)
+{
+  struct pingpong pp;
+  uint64_t start, cycles;
+  int i;
+
+  sema_init (&pp.ping, 0);
+  sema_init (&pp.pong, 0);
+  sema_init (&pp.done, 0);
+  pp.rounds = 0;
+
+  msg ("Switching %d times between two threads.", ROUND_CNT * 2);
+  thread_create ("partner", PRI_DEFAULT, partner, &pp);
+
+  /* Let the partner block on PING first. */
+  thread_yield ();
+
+  start = rdtsc ();
+  for (i = 0; i < ROUND_CNT; i++)
+    {
+      sema_up (&pp.ping);
+      sema_down (&pp.pong);
+      if (pp.rounds != i + 1)
+        fail ("partner is at round %d, expected %d", pp.rounds, i + 1);
+    }
+  cycles = rdtsc () - start;
+  sema_down (&pp.done);
+
+  printf ("switch-pingpong: %llu cycles per switch\n",
+          cycles / (ROUND_CNT * 2));
+  msg ("Partner completed all %d rounds.", ROUND_CNT);
+  pass ();
+}
+
+static void
+partner (void *pp_)
+{
+  struct pingpong *pp = pp_;
+  int i;
+
+  for (i = 0; i < ROUND_CNT; i++)
+    {
+      sema_down (&pp->ping);
+      pp->rounds++;
+      sema_up (&pp->pong);
+    }
+  sema_up (&pp->done);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# The cycle count varies from run to run, so don't compare it.
+@output = grep (!/^switch-pingpong: /, @output);
+
+compare_output ("run", \@output, [<<'EOF']);
+(switch-pingpong) begin
+(switch-pingpong) Switching 20000 times between two threads.
+(switch-pingpong) Partner completed all 10000 rounds.
+(switch-pingpong) PASS
+(switch-pingpong) end
+EOF
+pass;
@@ -17,6 +17,8 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-stress", test_alarm_stress},
+    {"alarm-cancel", test_alarm_cancel},
     {"priority-change", test_priority_change},
     {"priority-donate-one", test_priority_donate_one},
     {"priority-donate-multiple", test_priority_donate_multiple},
@@ -25,6 +27,7 @@ static const struct test tests[] =
     {"priority-donate-sema", test_priority_donate_sema},
     {"priority-donate-lower", test_priority_donate_lower},
     {"priority-donate-chain", test_priority_donate_chain},
+    {"priority-donate-deep", test_priority_donate_deep},
     {"priority-fifo", test_priority_fifo},
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
@@ -38,6 +41,16 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"spawn-rate", test_spawn_rate},
+    {"switch-pingpong", test_switch_pingpong},
+    {"condvar-many", test_condvar_many},
+    {"lock-fastpath", test_lock_fastpath},
+    {"rwlock-readers", test_rwlock_readers},
+    {"rwlock-multiple", test_rwlock_multiple},
+    {"edf-mixed", test_edf_mixed},
+    {"cfs-fair", test_cfs_fair},
+    {"workqueue", test_workqueue},
+    {"hrtimer-sleep", test_hrtimer_sleep},
   };
 
 static const char *test_name;
@@ -11,6 +11,8 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_stress;
+extern test_func test_alarm_cancel;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -19,6 +21,7 @@ extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
 extern test_func test_priority_donate_chain;
+extern test_func test_priority_donate_deep;
 extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
@@ -32,6 +35,16 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_spawn_rate;
+extern test_func test_switch_pingpong;
+extern test_func test_condvar_many;
+extern test_func test_lock_fastpath;
+extern test_func test_rwlock_readers;
+extern test_func test_rwlock_multiple;
+extern test_func test_edf_mixed;
+extern test_func test_cfs_fair;
+extern test_func test_workqueue;
+extern test_func test_hrtimer_sleep;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,147 @@
+/* Exercises the kernel work queues.
+
+   Work queued from a timer interrupt must run later in the
+   worker thread, with interrupts on, in the order it was queued.
+   Work queued on the high-priority queue must preempt the
+   (lower-priority) queuing thread, and work queued on the
+   low-priority queue must wait until that thread blocks.
+   Queuing an item that is already pending does nothing, delayed
+   work runs no earlier than its delay, and cancelled work never
+   runs. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+/* Number of items queued from the timer interrupt. */
+#define IRQ_WORK_CNT 3
+
+/* Delay of the delayed item, in ticks. */
+#define DELAY 10
+
+struct test_work
+  {
+    struct work work;           /* Work item. */
+    int run_cnt;                /* Number of times it ran. */
+    int order;                  /* Position among the items that ran. */
+    int64_t ran_at;             /* Tick on which it last ran. */
+    bool bad_context;           /* Ran with interrupts off or in an IRQ? */
+    char thread[16];            /* Name of the thread that ran it. */
+  };
+
+static int run_order;
+
+static void
+record (void *tw_)
+{
+  struct test_work *tw = tw_;
+
+  tw->run_cnt++;
+  tw->order = run_order++;
+  tw->ran_at = timer_ticks ();
+  tw->bad_context = intr_context () || intr_get_level () == INTR_OFF;
+  strlcpy (tw->thread, thread_name (), sizeof tw->thread);
+}
+
+static void
+init_work (struct test_work *tw)
+{
+  memset (tw, 0, sizeof *tw);
+  tw->order = -1;
+  work_init (&tw->work, record, tw);
+}
+
+static struct test_work irq_works[IRQ_WORK_CNT];
+
+/* Timer callback that queues IRQ_WORK_CNT items. */
+static void
+queue_from_irq (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < IRQ_WORK_CNT; i++)
+    if (!work_queue (&wq_default, &irq_works[i].work))
+      fail ("could not queue item %d from interrupt", i);
+}
+
+void
+test_workqueue (void)
+{
+  struct timer_event ev;
+  struct test_work high, low, delayed, cancelled, cancelled_delayed;
+  int64_t start;
+  int i;
+
+  /* This test does not work with the MLFQS or the CFS. */
+  ASSERT (!thread_mlfqs && !thread_cfs);
+
+  /* Work queued from an interrupt handler. */
+  msg ("Queuing %d items from the timer interrupt.", IRQ_WORK_CNT);
+  for (i = 0; i < IRQ_WORK_CNT; i++)
+    init_work (&irq_works[i]);
+  timer_event_init (&ev, queue_from_irq, NULL);
+  timer_add (&ev, timer_ticks () + 2);
+  timer_sleep (4);
+  workqueue_flush (&wq_default);
+  for (i = 0; i < IRQ_WORK_CNT; i++)
+    {
+      struct test_work *tw = &irq_works[i];
+
+      if (tw->run_cnt != 1)
+        fail ("item %d ran %d times", i, tw->run_cnt);
+      if (tw->order != i)
+        fail ("item %d ran in position %d", i, tw->order);
+      if (tw->bad_context)
+        fail ("item %d ran in interrupt context", i);
+      if (strcmp (tw->thread, "wq_default"))
+        fail ("item %d ran in thread \"%s\"", i, tw->thread);
+    }
+  msg ("They ran in order in the worker thread.");
+
+  /* Priorities. */
+  init_work (&high);
+  init_work (&low);
+  work_queue (&wq_high, &high.work);
+  if (high.run_cnt != 1)
+    fail ("high-priority work did not preempt us");
+  work_queue (&wq_low, &low.work);
+  if (work_queue (&wq_low, &low.work))
+    fail ("pending item was queued twice");
+  if (low.run_cnt != 0)
+    fail ("low-priority work preempted us");
+  workqueue_flush (&wq_low);
+  if (low.run_cnt != 1)
+    fail ("low-priority work ran %d times", low.run_cnt);
+  msg ("High-priority work ran at once, low-priority work ran once "
+       "we blocked.");
+
+  /* Delayed work and cancellation. */
+  init_work (&delayed);
+  init_work (&cancelled);
+  init_work (&cancelled_delayed);
+  start = timer_ticks ();
+  work_queue_delayed (&wq_default, &delayed.work, DELAY);
+  work_queue_delayed (&wq_default, &cancelled_delayed.work, DELAY);
+  work_queue (&wq_low, &cancelled.work);
+  if (!work_cancel (&cancelled.work) || !work_cancel (&cancelled_delayed.work))
+    fail ("could not cancel pending work");
+  if (work_cancel (&cancelled.work))
+    fail ("cancelled the same work twice");
+  timer_sleep (DELAY + 2);
+  workqueue_flush (&wq_default);
+  workqueue_flush (&wq_low);
+  if (delayed.run_cnt != 1)
+    fail ("delayed work ran %d times", delayed.run_cnt);
+  if (delayed.ran_at < start + DELAY)
+    fail ("delayed work ran after %lld ticks instead of %d",
+          delayed.ran_at - start, DELAY);
+  if (cancelled.run_cnt != 0 || cancelled_delayed.run_cnt != 0)
+    fail ("cancelled work ran");
+  msg ("Delayed work ran on time, cancelled work did not run.");
+  pass ();
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Queuing 3 items from the timer interrupt.
+(workqueue) They ran in order in the worker thread.
+(workqueue) High-priority work ran at once, low-priority work ran once we blocked.
+(workqueue) Delayed work ran on time, cancelled work did not run.
+(workqueue) PASS
+(workqueue) end
+EOF
+pass;
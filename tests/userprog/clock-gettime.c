@@ -0,0 +1,67 @@
+/* Checks clock_gettime().  The monotonic clock must never go
+   backward, must resolve much less than a 10 ms timer tick, and
+   must advance while this process spins.  The CPU-time clock
+   must advance while spinning too, and by no more than the
+   monotonic clock.  An unknown clock must be rejected.  The
+   actual values vary from run to run, so they are not
+   printed. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Nanoseconds in TS. */
+static int64_t
+ns (const struct timespec *ts)
+{
+  return ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+void
+test_main (void)
+{
+  struct timespec a, b, cpu_a, cpu_b;
+  int64_t finest = -1;
+  volatile int spin;
+  int i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      int64_t delta;
+
+      if (clock_gettime (CLOCK_MONOTONIC, &a) != 0
+          || clock_gettime (CLOCK_MONOTONIC, &b) != 0)
+        fail ("clock_gettime (CLOCK_MONOTONIC) failed");
+      if (a.tv_nsec < 0 || a.tv_nsec >= 1000000000)
+        fail ("tv_nsec out of range: %lld", a.tv_nsec);
+      delta = ns (&b) - ns (&a);
+      if (delta < 0)
+        fail ("monotonic clock went backward by %lld ns", -delta);
+      if (delta > 0 && (finest < 0 || delta < finest))
+        finest = delta;
+    }
+  if (finest < 0 || finest >= 1000000)
+    fail ("finest monotonic step %lld ns", finest);
+  msg ("monotonic clock never goes backward");
+  msg ("monotonic clock resolves less than a millisecond");
+
+  CHECK (clock_gettime (CLOCK_MONOTONIC, &a) == 0,
+         "clock_gettime (CLOCK_MONOTONIC)");
+  CHECK (clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &cpu_a) == 0,
+         "clock_gettime (CLOCK_PROCESS_CPUTIME_ID)");
+  for (spin = 0; spin < 1000000; spin++)
+    continue;
+  CHECK (clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &cpu_b) == 0,
+         "clock_gettime (CLOCK_PROCESS_CPUTIME_ID)");
+  CHECK (clock_gettime (CLOCK_MONOTONIC, &b) == 0,
+         "clock_gettime (CLOCK_MONOTONIC)");
+  if (ns (&b) <= ns (&a))
+    fail ("monotonic clock did not advance while spinning");
+  if (ns (&cpu_b) <= ns (&cpu_a))
+    fail ("CPU time did not advance while spinning");
+  if (ns (&cpu_b) - ns (&cpu_a) > ns (&b) - ns (&a))
+    fail ("CPU time advanced faster than the monotonic clock");
+  msg ("both clocks advance while spinning");
+
+  CHECK (clock_gettime (42, &a) == -1, "clock_gettime (42) fails");
+}
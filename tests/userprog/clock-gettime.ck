@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clock-gettime) begin
+(clock-gettime) monotonic clock never goes backward
+(clock-gettime) monotonic clock resolves less than a millisecond
+(clock-gettime) clock_gettime (CLOCK_MONOTONIC)
+(clock-gettime) clock_gettime (CLOCK_PROCESS_CPUTIME_ID)
+(clock-gettime) clock_gettime (CLOCK_PROCESS_CPUTIME_ID)
+(clock-gettime) clock_gettime (CLOCK_MONOTONIC)
+(clock-gettime) both clocks advance while spinning
+(clock-gettime) clock_gettime (42) fails
+(clock-gettime) end
+clock-gettime: exit(0)
+EOF
+pass;
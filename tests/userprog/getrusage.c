@@ -0,0 +1,50 @@
+/* Checks the CPU usage reported by getrusage().  Spins in user
+   mode and makes a few system calls, then checks that both user
+   and kernel time were charged to this process.  Then runs a
+   short-lived child, which would round down to zero ticks, and
+   checks that its time shows up among the children's usage once
+   it has been waited for, and that waiting for it counted as a
+   voluntary context switch.  The actual values vary from run to
+   run, so they are not printed. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  struct rusage self, children;
+  volatile int spin;
+  int pid, i;
+
+  for (spin = 0; spin < 1000000; spin++)
+    continue;
+  for (i = 0; i < 10; i++)
+    if (getrusage (RUSAGE_SELF, &self) != 0)
+      fail ("getrusage (RUSAGE_SELF) failed");
+  if (self.utime == 0 || self.stime == 0)
+    fail ("user time %llu, kernel time %llu", self.utime, self.stime);
+  msg ("user and kernel time are charged to the process");
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  if (children.utime != 0 || children.stime != 0)
+    fail ("children have usage before any child was waited for");
+
+  if ((pid = fork ("child-simple")) == 0)
+    exec ("child-simple");
+  msg ("wait(exec()) = %d", wait (pid));
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  if (children.utime == 0 || children.stime == 0)
+    fail ("child user time %llu, kernel time %llu",
+          children.utime, children.stime);
+  msg ("the reaped child's time is reported");
+
+  CHECK (getrusage (RUSAGE_SELF, &self) == 0, "getrusage (RUSAGE_SELF)");
+  if (self.nvcsw == 0)
+    fail ("waiting did not count as a voluntary context switch");
+  CHECK (getrusage (42, &self) == -1, "getrusage (42) fails");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage) begin
+(getrusage) user and kernel time are charged to the process
+(getrusage) getrusage (RUSAGE_CHILDREN)
+(child-simple) run
+child-simple: exit(81)
+(getrusage) wait(exec()) = 81
+(getrusage) getrusage (RUSAGE_CHILDREN)
+(getrusage) the reaped child's time is reported
+(getrusage) getrusage (RUSAGE_SELF)
+(getrusage) getrusage (42) fails
+(getrusage) end
+getrusage: exit(0)
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Snapshots the kernel's lock contention statistics with
+   lockstat() after some file system activity, and checks that
+   the file system lock is among the reported lock classes and
+   that the classes come sorted by contention.  The counts are
+   only collected when the kernel runs with -lockstat, so their
+   values are not checked. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Lock classes to ask for. */
+#define CLASS_CNT 64
+
+static struct lockstat stats[CLASS_CNT];
+
+void
+test_main (void)
+{
+  int cnt, i;
+  bool found = false;
+
+  CHECK (open ("sample.txt") > 1, "open \"sample.txt\"");
+  CHECK (lockstat (stats, 0) == 0, "empty snapshot");
+
+  cnt = lockstat (stats, CLASS_CNT);
+  CHECK (cnt > 0 && cnt <= CLASS_CNT, "snapshot lock classes");
+  for (i = 0; i < cnt; i++)
+    {
+      if (!strcmp (stats[i].name, "filesys.c:filesys_lock"))
+        found = true;
+      if (i > 0 && stats[i].contended > stats[i - 1].contended)
+        fail ("%s is more contended than %s",
+              stats[i].name, stats[i - 1].name);
+    }
+  CHECK (found, "filesys_lock is reported");
+}
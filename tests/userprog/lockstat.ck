@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lockstat) begin
+(lockstat) open "sample.txt"
+(lockstat) empty snapshot
+(lockstat) snapshot lock classes
+(lockstat) filesys_lock is reported
+(lockstat) end
+lockstat: exit(0)
+EOF
+pass;
@@ -0,0 +1,40 @@
+/* Lowers the per-process file descriptor limit with fdlimit()
+   and checks that open() and dup2() respect it, then raises it
+   again and opens enough files to force the descriptor table to
+   grow past its inline slots.  Finally asks for an absurdly high
+   limit, which must be capped, and dup2()s to a high descriptor. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Files opened after the limit is raised. */
+#define MANY_CNT 90
+
+void
+test_main (void) 
+{
+  int i, fd;
+
+  CHECK (fdlimit (0) == 512, "default limit is 512");
+  CHECK (fdlimit (4) == 4, "lower limit to 4");
+  CHECK (open ("sample.txt") == 2, "open \"sample.txt\" as fd 2");
+  CHECK (open ("sample.txt") == 3, "open \"sample.txt\" as fd 3");
+  CHECK (open ("sample.txt") == -1, "open beyond the limit fails");
+  CHECK (dup2 (2, 10) == -1, "dup2 beyond the limit fails");
+
+  CHECK (fdlimit (100) == 100, "raise limit to 100");
+  msg ("open \"sample.txt\" %d more times", MANY_CNT);
+  for (i = 0; i < MANY_CNT; i++)
+    {
+      fd = open ("sample.txt");
+      if (fd != 4 + i)
+        fail ("open returned %d instead of %d", fd, 4 + i);
+    }
+  CHECK (fdlimit (3) == -1, "cannot lower limit below an open fd");
+
+  CHECK (fdlimit (INT_MAX) == 65536, "limit of INT_MAX is capped at 65536");
+  CHECK (dup2 (2, 1000) == 1000, "dup2 to fd 1000");
+  CHECK (dup2 (2, 65536) == -1, "dup2 beyond the cap fails");
+}
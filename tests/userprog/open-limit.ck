@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-limit) begin
+(open-limit) default limit is 512
+(open-limit) lower limit to 4
+(open-limit) open "sample.txt" as fd 2
+(open-limit) open "sample.txt" as fd 3
+(open-limit) open beyond the limit fails
+(open-limit) dup2 beyond the limit fails
+(open-limit) raise limit to 100
+(open-limit) open "sample.txt" 90 more times
+(open-limit) cannot lower limit below an open fd
+(open-limit) limit of INT_MAX is capped at 65536
+(open-limit) dup2 to fd 1000
+(open-limit) dup2 beyond the cap fails
+(open-limit) end
+open-limit: exit(0)
+EOF
+pass;
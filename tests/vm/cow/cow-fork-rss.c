@@ -0,0 +1,77 @@
+/* Measures fork latency against the parent's resident memory.
+   The parent dirties a growing number of pages of a bss array and
+   forks a child that checks one page, writes to it and exits.
+   With copy-on-write the fork only shares the parent's frames, so
+   its cost should barely grow with the number of resident pages.
+
+   The test fails if the child sees the wrong data or the parent
+   sees the child's write.  The per-fork times are printed, and
+   cow-fork-rss.ck checks that the time with MAX_PAGES resident is
+   within a bound of the time with none. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+/* Largest number of resident pages tried. */
+#define MAX_PAGES 512
+
+/* Number of forks timed for each size.  Averaging over several
+   forks keeps one slow fork from failing the check. */
+#define ROUND_CNT 8
+
+static char buf[MAX_PAGES * PAGE_SIZE];
+
+static int64_t
+now_us (void)
+{
+	struct timespec ts;
+
+	if (clock_gettime (CLOCK_MONOTONIC, &ts) != 0)
+		fail ("clock_gettime (CLOCK_MONOTONIC) failed");
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+void
+test_main (void)
+{
+	static const int sizes[] = {0, 32, 128, MAX_PAGES};
+	size_t i;
+
+	for (i = 0; i < sizeof sizes / sizeof *sizes; i++) {
+		int pages = sizes[i];
+		int64_t total = 0;
+		int round, p;
+
+		for (p = 0; p < pages; p++)
+			buf[p * PAGE_SIZE] = (char) (p + 1);
+
+		for (round = 0; round < ROUND_CNT; round++) {
+			int64_t start = now_us ();
+			pid_t child = fork ("child");
+
+			if (child == 0) {
+				/* Fail by exit code so the parent's output stays the same. */
+				if (pages > 0 && buf[(pages - 1) * PAGE_SIZE] != (char) pages)
+					exit (1);
+				buf[0] = '@';
+				exit (0);
+			}
+			if (child < 0)
+				fail ("fork failed with %d pages resident", pages);
+			if (wait (child) != 0)
+				fail ("child saw wrong data with %d pages resident", pages);
+			total += now_us () - start;
+			if (pages > 0 && buf[0] != 1)
+				fail ("child's write is visible in the parent");
+		}
+		printf ("cow-fork-rss: %d pages resident: %lld us per fork\n",
+				pages, total / ROUND_CNT);
+	}
+	msg ("Forked with up to %d resident pages.", MAX_PAGES);
+}
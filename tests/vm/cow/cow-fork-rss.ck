@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+# Absolute fork times depend on the host, so only their ratio is
+# checked.  Copying 512 pages would make the fork several times
+# slower, but with copy-on-write it should cost at most twice as
+# much as forking with no resident pages, plus 100 us of slack so a
+# very fast baseline fork doesn't make the bound meaninglessly tight.
+my (%us) = map (/^cow-fork-rss: (\d+) pages resident: (\d+) us per fork$/,
+		@output);
+fail "missing fork time with 0 or 512 resident pages\n"
+  if !defined $us{0} || !defined $us{512};
+fail "fork took $us{512} us with 512 resident pages, "
+  . "but only $us{0} us with none\n"
+  if $us{512} > 2 * $us{0} + 100;
+@output = grep (!/^cow-fork-rss: \d+ pages resident: /, @output);
+
+compare_output ("run", IGNORE_EXIT_CODES => 1, \@output, [<<'EOF']);
+(cow-fork-rss) begin
+(cow-fork-rss) Forked with up to 512 resident pages.
+(cow-fork-rss) end
+EOF
+pass;
@@ -9,6 +9,7 @@
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
+#include "devices/lapic.h"
 #include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
@@ -103,12 +104,28 @@ static const char *intr_names[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* 외부 인터럽트 벡터. 0x20...0x2f는 8259A PIC에서,
+   0x30...0x3f는 local APIC에서 온다. */
+#define EXT_FIRST 0x20
+#define EXT_LAPIC 0x30
+#define EXT_CNT 32
+
+/* 외부 인터럽트별 처리 시간 (rdtsc 사이클).
+   핸들러에 들어와서 EOI를 보낼 때까지이며,
+   돌아가며 하는 문맥 교환은 넣지 않는다. */
+static struct {
+	int64_t cnt;                /* 처리 횟수. */
+	uint64_t cycles;            /* 처리 시간 합. */
+	uint64_t max_cycles;        /* 가장 긴 처리 시간. */
+} ext_stats[EXT_CNT];
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
 
 /* Interrupt handlers. */
 void intr_handler (struct intr_frame *args);
+static void intr_account (int irq, uint64_t cycles);
 
 /* Returns the current interrupt status. */
 enum intr_level
@@ -223,11 +240,12 @@ register_handler (uint8_t vec_no, int dpl, enum intr_level level,
 
 /* Registers external interrupt VEC_NO to invoke HANDLER, which
    is named NAME for debugging purposes.  The handler will
-   execute with interrupts disabled. */
+   execute with interrupts disabled.  Vectors 0x20...0x2f come
+   from the PIC and 0x30...0x3f from the local APIC. */
 void
 intr_register_ext (uint8_t vec_no, intr_handler_func *handler,
 		const char *name) {
-	ASSERT (vec_no >= 0x20 && vec_no <= 0x2f);
+	ASSERT (vec_no >= EXT_FIRST && vec_no < EXT_FIRST + EXT_CNT);
 	register_handler (vec_no, 0, INTR_OFF, handler, name);
 }
 
@@ -248,7 +266,7 @@ void
 intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 		intr_handler_func *handler, const char *name)
 {
-	ASSERT (vec_no < 0x20 || vec_no > 0x2f);
+	ASSERT (vec_no < EXT_FIRST || vec_no >= EXT_FIRST + EXT_CNT);
 	register_handler (vec_no, dpl, level, handler, name);
 }
 
@@ -331,19 +349,32 @@ pic_end_of_interrupt (int irq) {
 void
 intr_handler (struct intr_frame *frame) {
 	bool external;
+	bool from_user = (frame->cs & 3) == 3;
 	intr_handler_func *handler;
+	uint64_t start = 0;
+
+	/* 유저 모드에서 들어왔으면 여기부터 커널 시간이다. */
+	if (from_user)
+		thread_account_enter ();
 
 	/* External interrupts are special.
 	   We only handle one at a time (so interrupts must be off)
 	   and they need to be acknowledged on the PIC (see below).
 	   An external interrupt handler cannot sleep. */
-	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+	external = frame->vec_no >= EXT_FIRST
+		&& frame->vec_no < EXT_FIRST + EXT_CNT;
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
 		ASSERT (!intr_context ());
 
 		in_external_intr = true;
 		yield_on_return = false;
+		start = rdtsc ();
+
+		/* tickless 모드로 idle 중에 다른 장치가 깨웠다면 지나간 틱부터
+		   따라잡는다. 타이머 자신의 인터럽트는 timer_interrupt()가 처리. */
+		if (frame->vec_no != 0x20)
+			timer_idle_exit ();
 	}
 
 	/* Invoke the interrupt's handler. */
@@ -367,11 +398,39 @@ intr_handler (struct intr_frame *frame) {
 		ASSERT (intr_context ());
 
 		in_external_intr = false;
-		pic_end_of_interrupt (frame->vec_no);
+		if (frame->vec_no >= EXT_LAPIC)
+			lapic_eoi ();
+		else
+			pic_end_of_interrupt (frame->vec_no);
+		intr_account (frame->vec_no - EXT_FIRST, rdtsc () - start);
 
 		if (yield_on_return)
 			thread_yield ();
 	}
+
+	if (from_user)
+		thread_account_leave ();
+}
+
+/* IRQ번 외부 인터럽트 처리에 CYCLES가 걸렸다. */
+static void
+intr_account (int irq, uint64_t cycles) {
+	ext_stats[irq].cnt++;
+	ext_stats[irq].cycles += cycles;
+	if (cycles > ext_stats[irq].max_cycles)
+		ext_stats[irq].max_cycles = cycles;
+}
+
+/* 외부 인터럽트별 처리 횟수와 평균/최대 처리 시간을 출력한다. */
+void
+intr_print_stats (void) {
+	for (int irq = 0; irq < EXT_CNT; irq++)
+		if (ext_stats[irq].cnt > 0)
+			printf ("Interrupt %#04x (%s): %lld times, "
+					"avg %llu cycles, max %llu cycles\n",
+					irq + EXT_FIRST, intr_names[irq + EXT_FIRST], ext_stats[irq].cnt,
+					ext_stats[irq].cycles / ext_stats[irq].cnt,
+					ext_stats[irq].max_cycles);
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
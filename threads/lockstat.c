@@ -0,0 +1,188 @@
+#include <lockstat.h>
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "intrinsic.h"
+
+/* 락 경합 프로파일러.
+   커널 옵션 -lockstat이 켜져 있으면 모든 struct lock의 획득 횟수,
+   경합 횟수, 대기/보유 시간을 rdtsc로 재어 초기화 위치별 클래스에
+   모은다. 꺼져 있어도 클래스 등록은 하므로 lockstat()으로 이름은
+   볼 수 있다. */
+
+/* -lockstat: 락 통계를 모을지. */
+bool lockstat_enabled;
+
+/* 등록할 수 있는 클래스 수. 넘치면 나머지는 overflow에 모은다. */
+#define LOCKSTAT_CLASS_MAX 128
+
+/* 종료 시 출력할 클래스 수. */
+#define LOCKSTAT_PRINT_CNT 10
+
+static struct lockstat classes[LOCKSTAT_CLASS_MAX];
+static const char *class_keys[LOCKSTAT_CLASS_MAX];
+static int class_cnt;
+static struct lockstat overflow = { .name = "(other)" };
+
+/* KEY ("../../filesys/inode.c:&inode->inode_lock")를
+   "inode.c:inode->inode_lock" 모양으로 줄여 NAME에 쓴다. */
+static void
+class_name (char name[LOCKSTAT_NAME_LEN], const char *key) {
+	const char *colon = strchr (key, ':');
+	const char *file = key;
+	const char *p;
+
+	if (colon == NULL) {
+		strlcpy (name, key, LOCKSTAT_NAME_LEN);
+		return;
+	}
+	for (p = key; p < colon; p++)
+		if (*p == '/')
+			file = p + 1;
+	p = colon + 1;
+	while (*p == ' ' || *p == '&')
+		p++;
+
+	/* printf()의 "%.*s"는 x86-64에서 인자를 잘못 읽으므로 쓰지 않는다. */
+	strlcpy (name, file, LOCKSTAT_NAME_LEN);
+	if ((size_t) (colon - file) < LOCKSTAT_NAME_LEN)
+		name[colon - file] = '\0';
+	strlcat (name, ":", LOCKSTAT_NAME_LEN);
+	strlcat (name, p, LOCKSTAT_NAME_LEN);
+}
+
+/* lock_init()의 위치 문자열 KEY에 해당하는 클래스를 찾고,
+   없으면 새로 등록한다. */
+struct lockstat *
+lockstat_class (const char *key) {
+	struct lockstat *s = &overflow;
+	enum intr_level old_level = intr_disable ();
+	int i;
+
+	for (i = 0; i < class_cnt; i++)
+		if (class_keys[i] == key || !strcmp (class_keys[i], key)) {
+			s = &classes[i];
+			goto done;
+		}
+	if (class_cnt < LOCKSTAT_CLASS_MAX) {
+		s = &classes[class_cnt];
+		class_keys[class_cnt++] = key;
+		class_name (s->name, key);
+	}
+done:
+	intr_set_level (old_level);
+	return s;
+}
+
+/* LOCK을 얻었다. WAIT_START가 0이 아니면 그때부터 기다렸다. */
+void
+lockstat_acquired (struct lock *lock, uint64_t wait_start) {
+	struct lockstat *s = lock->stat;
+	uint64_t now = rdtsc ();
+
+	if (s == NULL)
+		return;
+	__atomic_fetch_add (&s->acquired, 1, __ATOMIC_RELAXED);
+	if (wait_start != 0) {
+		uint64_t wait = now - wait_start;
+		int bucket = wait != 0 ? 63 - __builtin_clzll (wait) : 0;
+
+		if (bucket >= LOCKSTAT_HIST_CNT)
+			bucket = LOCKSTAT_HIST_CNT - 1;
+		__atomic_fetch_add (&s->contended, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add (&s->wait_total, wait, __ATOMIC_RELAXED);
+		__atomic_fetch_add (&s->wait_hist[bucket], 1, __ATOMIC_RELAXED);
+	}
+	lock->acquire_tsc = now;
+}
+
+/* LOCK을 놓는다. 얻은 뒤 지난 시간을 보유 시간에 더한다. */
+void
+lockstat_released (struct lock *lock) {
+	struct lockstat *s = lock->stat;
+	uint64_t hold;
+
+	if (s == NULL || lock->acquire_tsc == 0)
+		return;
+	hold = rdtsc () - lock->acquire_tsc;
+	lock->acquire_tsc = 0;
+	__atomic_fetch_add (&s->hold_total, hold, __ATOMIC_RELAXED);
+	if (hold > s->hold_max)
+		s->hold_max = hold;
+}
+
+/* 경합 횟수가 많은 순, 같으면 획득 횟수가 많은 순. */
+static bool
+more_contended (const struct lockstat *a, const struct lockstat *b) {
+	if (a->contended != b->contended)
+		return a->contended > b->contended;
+	return a->acquired > b->acquired;
+}
+
+/* 등록된 클래스 (넘친 것 포함)를 경합 순으로 ORDER에 채우고 개수를 반환. */
+static int
+sorted_classes (struct lockstat *order[LOCKSTAT_CLASS_MAX + 1]) {
+	int cnt = 0;
+	int i, j;
+
+	for (i = 0; i < class_cnt; i++)
+		order[cnt++] = &classes[i];
+	if (overflow.acquired != 0)
+		order[cnt++] = &overflow;
+
+	for (i = 1; i < cnt; i++) {
+		struct lockstat *s = order[i];
+		for (j = i; j > 0 && more_contended (s, order[j - 1]); j--)
+			order[j] = order[j - 1];
+		order[j] = s;
+	}
+	return cnt;
+}
+
+/* lockstat_snapshot()이 돌려줄 수 있는 클래스 수 (넘친 것 포함). */
+int
+lockstat_class_cnt (void) {
+	return class_cnt + (overflow.acquired != 0);
+}
+
+/* 경합 순 상위 MAX개 클래스를 BUF에 복사하고 복사한 개수를 반환. */
+int
+lockstat_snapshot (struct lockstat *buf, int max) {
+	struct lockstat *order[LOCKSTAT_CLASS_MAX + 1];
+	int cnt = sorted_classes (order);
+	int i;
+
+	if (cnt > max)
+		cnt = max;
+	for (i = 0; i < cnt; i++)
+		memcpy (&buf[i], order[i], sizeof *buf);
+	return cnt;
+}
+
+/* 경합이 가장 심한 락 클래스들의 표를 출력한다. */
+void
+lockstat_print_stats (void) {
+	struct lockstat *order[LOCKSTAT_CLASS_MAX + 1];
+	int cnt, i;
+
+	if (!lockstat_enabled)
+		return;
+
+	cnt = sorted_classes (order);
+	if (cnt > LOCKSTAT_PRINT_CNT)
+		cnt = LOCKSTAT_PRINT_CNT;
+	printf ("Lock contention (cycles):\n");
+	printf ("%-32s %10s %10s %12s %12s %12s\n",
+			"lock", "acquired", "contended", "avg wait", "avg hold", "max hold");
+	for (i = 0; i < cnt; i++) {
+		struct lockstat *s = order[i];
+
+		printf ("%-32s %10llu %10llu %12llu %12llu %12llu\n", s->name,
+				s->acquired, s->contended,
+				s->contended ? s->wait_total / s->contended : 0,
+				s->acquired ? s->hold_total / s->acquired : 0,
+				s->hold_max);
+	}
+}
@@ -10,6 +10,7 @@
 #include "threads/init.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -268,6 +269,14 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	lock_release (&pool->lock);
 	void *pages;
 
+	/* 커널 풀이 부족하면 스레드 페이지 캐시를 비우고 한 번 더 시도 */
+	if (page_idx == BITMAP_ERROR && pool == &kernel_pool
+			&& thread_cache_reclaim () > 0) {
+		lock_acquire (&pool->lock);
+		page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+		lock_release (&pool->lock);
+	}
+
 	if (page_idx != BITMAP_ERROR)
 		pages = pool->base + PGSIZE * page_idx;
 	else
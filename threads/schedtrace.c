@@ -0,0 +1,129 @@
+#include "threads/schedtrace.h"
+#include <debug.h>
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+/* 스케줄러 이벤트 트레이서.
+   커널 옵션 -schedtrace가 켜져 있으면 문맥 교환, 깨움, 잠듦, 선점,
+   타이머 깨움, 우선순위 기부를 고정 크기 링 버퍼에 기록하고, 종료할 때
+   시리얼로 덤프한다. 기록은 인덱스 하나를 원자적으로 늘리고 24바이트
+   레코드를 채우는 것뿐이라 락도 할당도 없다. 버퍼가 차면 가장 오래된
+   레코드부터 덮어쓴다. 덤프는 utils/schedtrace로 분석한다. */
+
+/* -schedtrace: 스케줄러 이벤트를 기록할지. */
+bool schedtrace_enabled;
+
+/* 링 버퍼의 레코드 수. 2의 거듭제곱이어야 한다. */
+#define SCHEDTRACE_SIZE 8192
+
+/* 이름을 기억해 둘 스레드 수. tid로 덮어쓴다. */
+#define SCHEDTRACE_NAME_CNT 256
+
+static struct schedtrace_event *ring;
+static uint64_t ring_head;
+
+/* 스레드 이름. 레코드에는 tid만 남기고 이름은 따로 둔다. */
+static struct
+  {
+    int32_t tid;
+    char name[16];
+  }
+names[SCHEDTRACE_NAME_CNT];
+
+/* 덤프에서 TSC를 시간으로 바꾸기 위한 기준점. */
+static uint64_t start_tsc;
+static int64_t start_ticks;
+
+static const char *type_names[SCHEDTRACE_TYPE_CNT] = {
+	"switch", "unblock", "block", "preempt", "timer", "donate", "create",
+};
+
+/* 링 버퍼를 할당한다. -schedtrace가 없으면 아무것도 하지 않는다.
+   palloc_init() 이후에 불려야 하며, 그 전의 이벤트는 버린다. */
+void
+schedtrace_init (void) {
+	size_t pages = DIV_ROUND_UP (SCHEDTRACE_SIZE * sizeof *ring, PGSIZE);
+
+	if (!schedtrace_enabled)
+		return;
+	ring = palloc_get_multiple (PAL_ZERO, pages);
+	if (ring == NULL) {
+		printf ("schedtrace: no memory for %d events, tracing disabled\n",
+				SCHEDTRACE_SIZE);
+		schedtrace_enabled = false;
+		return;
+	}
+	start_tsc = rdtsc ();
+	start_ticks = timer_ticks ();
+	schedtrace_name (thread_current ());
+}
+
+/* T에 대한 TYPE 이벤트를 인자 ARG와 함께 기록한다.
+   인터럽트 컨텍스트를 포함해 어디서든 불릴 수 있다. */
+void
+schedtrace_record (enum schedtrace_type type, const struct thread *t, int arg) {
+	struct schedtrace_event *e;
+	uint64_t i;
+
+	if (ring == NULL)
+		return;
+	i = __atomic_fetch_add (&ring_head, 1, __ATOMIC_RELAXED);
+	e = &ring[i & (SCHEDTRACE_SIZE - 1)];
+	e->tsc = rdtsc ();
+	e->tid = t->tid;
+	e->arg = arg;
+	e->type = type;
+	e->priority = t->priority;
+	e->status = t->status;
+}
+
+/* 새 스레드 T의 이름을 기억한다. */
+void
+schedtrace_name (const struct thread *t) {
+	int slot = t->tid % SCHEDTRACE_NAME_CNT;
+
+	if (ring == NULL)
+		return;
+	names[slot].tid = t->tid;
+	strlcpy (names[slot].name, t->name, sizeof names[slot].name);
+}
+
+/* 링 버퍼를 오래된 레코드부터 콘솔(시리얼)로 내보낸다.
+   각 줄은 "schedtrace: "로 시작한다. */
+void
+schedtrace_dump (void) {
+	uint64_t head, first, i, hz = 0;
+	int64_t ticks;
+	int slot;
+
+	if (ring == NULL)
+		return;
+
+	/* 덤프하는 동안 생기는 이벤트는 기록하지 않는다 */
+	schedtrace_enabled = false;
+	head = ring_head;
+	first = head > SCHEDTRACE_SIZE ? head - SCHEDTRACE_SIZE : 0;
+	ticks = timer_ticks () - start_ticks;
+	if (ticks > 0)
+		hz = (rdtsc () - start_tsc) / ticks * TIMER_FREQ;
+
+	printf ("schedtrace: begin events=%llu lost=%llu hz=%llu\n",
+			head - first, first, hz);
+	for (slot = 0; slot < SCHEDTRACE_NAME_CNT; slot++)
+		if (names[slot].tid != 0)
+			printf ("schedtrace: thread %d %s\n", names[slot].tid, names[slot].name);
+	for (i = first; i < head; i++) {
+		struct schedtrace_event *e = &ring[i & (SCHEDTRACE_SIZE - 1)];
+
+		printf ("schedtrace: %llu %s %d %d %u %u\n",
+				e->tsc, type_names[e->type], e->tid, e->arg,
+				e->priority, e->status);
+	}
+	printf ("schedtrace: end\n");
+}
@@ -30,7 +30,9 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -99,6 +101,18 @@ bool sema_try_down(struct semaphore *sema)
 	return success;
 }
 
+/* WAITERS에 있는 BLOCKED 스레드들의 mlfqs 값을 최신으로 맞춘다.
+   정렬 전에 호출해야 매 초 전체를 갱신했을 때와 같은 순서가 나온다. */
+static void
+mlfqs_refresh_waiters(struct list *waiters)
+{
+	struct list_elem *e;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	for (e = list_begin(waiters); e != list_end(waiters); e = list_next(e))
+		mlfqs_refresh(list_entry(e, struct thread, elem));
+}
+
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
    and wakes up one thread of those waiting for SEMA, if any.
 
@@ -112,6 +126,10 @@ void sema_up(struct semaphore *sema)
 	old_level = intr_disable();
 	if (!list_empty(&sema->waiters))
 	{
+		/* mlfqs에서는 대기 중에 미뤄둔 감쇠를 먼저 적용 */
+		if (thread_mlfqs)
+			mlfqs_refresh_waiters(&sema->waiters);
+
 		/* 기부로 우선순위가 바뀌었을 수 있으니 재정렬을 수행*/
 		list_sort(&sema->waiters, thread_priority_greater, NULL);
 		thread_unblock(list_entry(list_pop_front(&sema->waiters),
@@ -165,22 +183,45 @@ sema_test_helper(void *sema_)
    is, it is an error for the thread currently holding a lock to
    try to acquire that lock.
 
-   A lock is a specialization of a semaphore with an initial
-   value of 1.  The difference between a lock and such a
-   semaphore is twofold.  First, a semaphore can have a value
-   greater than 1, but a lock can only be owned by a single
-   thread at a time.  Second, a semaphore does not have an owner,
-   meaning that one thread can "down" the semaphore and then
-   another one "up" it, but with a lock the same thread must both
-   acquire and release it.  When these restrictions prove
-   onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
-void lock_init(struct lock *lock)
+   A lock behaves like a semaphore with an initial value of 1.
+   The difference between a lock and such a semaphore is twofold.
+   First, a semaphore can have a value greater than 1, but a lock
+   can only be owned by a single thread at a time.  Second, a
+   semaphore does not have an owner, meaning that one thread can
+   "down" the semaphore and then another one "up" it, but with a
+   lock the same thread must both acquire and release it.  When
+   these restrictions prove onerous, it's a good sign that a
+   semaphore should be used, instead of a lock.
+
+   The lock state lives in the single word LOCK->owner: the
+   holding thread, or 0 if free, with LOCK_CONTENDED set while
+   threads are blocked on it.  An uncontended acquire or release
+   is one compare-and-swap on that word and never disables
+   interrupts or touches the donation machinery.  Only when the
+   swap fails do we take the slow path, which blocks the thread
+   and donates its priority as before.
+
+   lock_init() is a macro that passes the place it was called
+   from as NAME, which selects the lock's profiling class. */
+void lock_init_named(struct lock *lock, const char *name)
 {
 	ASSERT(lock != NULL);
 
 	lock->holder = NULL;
-	sema_init(&lock->semaphore, 1);
+	lock->owner = 0;
+	list_init(&lock->waiters);
+	lock->tracked = false;
+	pairheap_init(&lock->donors, thread_donor_less, NULL);
+	lock->stat = lockstat_class(name);
+	lock->acquire_tsc = 0;
+}
+
+/* LOCK->owner가 OLD이면 NEW로 바꾸고 true. */
+static inline bool
+lock_cas(struct lock *lock, uintptr_t old, uintptr_t new)
+{
+	return __atomic_compare_exchange_n(&lock->owner, &old, new, false,
+									   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -193,32 +234,60 @@ void lock_init(struct lock *lock)
    we need to sleep. */
 void lock_acquire(struct lock *lock)
 {
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+	uint64_t wait_start;
+
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(!lock_held_by_current_thread(lock));
 
-	/*mlfqs opt*/
-	if (thread_mlfqs)
+	/* 1) fast path : 비어 있으면 CAS 한 번으로 끝 */
+	if (lock_cas(lock, 0, (uintptr_t)cur))
 	{
-		sema_down(&lock->semaphore);
-		lock->holder = thread_current();
+		lock->holder = cur;
+		if (lockstat_enabled)
+			lockstat_acquired(lock, 0);
 		return;
 	}
 
-	struct thread *cur = thread_current();
-	/* 1) 락 소유자가 있고, 내가 더 높은 우선순위면 기부 */
-	if (lock->holder != NULL)
+	/* 여기서부터는 경합. 기다린 시간을 잰다 */
+	wait_start = lockstat_enabled ? rdtsc() : 0;
+
+	/* 2) slow path : 대기자가 있음을 표시하고 소유자에게 기부한 뒤 잠든다.
+		깨어나면 다시 시도한다. 그 사이 다른 스레드가 먼저 가져갔으면
+		그 스레드에게 다시 기부하고 잠든다 */
+	old_level = intr_disable();
+	for (;;)
 	{
-		cur->waiting_lock = lock; // 내가 기다리는 락 기록
-		thread_donate_priority(); // 락 소유자에게 내 우선순위 기부
+		uintptr_t word = lock->owner;
+
+		if (word == 0)
+		{
+			if (lock_cas(lock, 0, (uintptr_t)cur))
+				break;
+			continue;
+		}
+		if (!(word & LOCK_CONTENDED) && !lock_cas(lock, word, word | LOCK_CONTENDED))
+			continue;
+
+		if (!thread_mlfqs)
+			thread_donate_priority(lock); // 락 소유자에게 내 우선순위 기부
+		list_push_back(&lock->waiters, &cur->elem);
+		thread_block();
 	}
-	/* 2) 실제로 세마포어 하나를 얻으려고 시도.
-		세마포어가 0이면 우선순위 순서로 대기열에 넣고 블록(blocked) */
-	sema_down(&lock->semaphore); // lock->semaphore는 1칸짜리
 
-	/* 3) 락 획득 성공 */
-	lock->holder = cur;
-	cur->waiting_lock = NULL;
+	/* 3) 락 획득 성공. 남은 대기자가 있으면 release가 slow path를 타도록
+		표시하고, 소유자가 되면서 그들의 기부를 이어받는다 */
+	if (!list_empty(&lock->waiters))
+		__atomic_or_fetch(&lock->owner, LOCK_CONTENDED, __ATOMIC_RELAXED);
+	if (thread_mlfqs)
+		lock->holder = cur;
+	else
+		thread_take_donations_for_lock(lock);
+	if (lockstat_enabled)
+		lockstat_acquired(lock, wait_start);
+	intr_set_level(old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -229,15 +298,17 @@ void lock_acquire(struct lock *lock)
    interrupt handler. */
 bool lock_try_acquire(struct lock *lock)
 {
-	bool success;
+	struct thread *cur = thread_current();
 
 	ASSERT(lock != NULL);
 	ASSERT(!lock_held_by_current_thread(lock));
 
-	success = sema_try_down(&lock->semaphore);
-	if (success)
-		lock->holder = thread_current();
-	return success;
+	if (!lock_cas(lock, 0, (uintptr_t)cur))
+		return false;
+	lock->holder = cur;
+	if (lockstat_enabled)
+		lockstat_acquired(lock, 0);
+	return true;
 }
 
 /* Releases LOCK, which must be owned by the current thread.
@@ -247,33 +318,57 @@ bool lock_try_acquire(struct lock *lock)
    make sense to try to release a lock within an interrupt
    handler.
 
-   thread_remove_dontaions_for_lock()으로 락 관련 기부들을 제거
-   thread_update_priority()로 남은 기부들과 base_priority 비교
+   기다리는 스레드도, 받은 기부도 없으면 CAS 한 번으로 끝난다.
+   아니면 thread_remove_dontaions_for_lock()으로 락 관련 기부들을 제거 (O(log n))
+   thread_update_priority()로 남은 기부들과 base_priority 비교 (O(1))
+   후 가장 높은 우선순위의 대기자를 깨운다.
    */
 void lock_release(struct lock *lock)
 {
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
 
+	if (lockstat_enabled)
+		lockstat_released(lock);
+
+	/* 1) fast path : LOCK_CONTENDED가 없으면 대기자가 없다 */
 	lock->holder = NULL;
-	if (thread_mlfqs)
-	{
-		sema_up(&lock->semaphore);
+	if (!lock->tracked && lock_cas(lock, (uintptr_t)cur, 0))
 		return;
-	}
 
-	struct thread *cur = thread_current();
+	/* 2) slow path */
+	old_level = intr_disable();
+	if (!thread_mlfqs)
+	{
+		/* lock_release()에서 lock과 관련된 기부자들을 제거하는 함수*/
+		thread_remove_donations_for_lock(lock);
 
-	lock->holder = NULL;
+		/* 기부 제거 후 base_priority / 남은 락들의 기부 중 최댓값으로
+							우선순위 업데이트해주는 함수*/
+		thread_update_priority();
+	}
+	__atomic_store_n(&lock->owner, 0, __ATOMIC_RELEASE);
 
-	/* lock_release()에서 lock과 관련된 기부자들을 제거하는 함수*/
-	thread_remove_donations_for_lock(lock);
+	if (!list_empty(&lock->waiters))
+	{
+		struct list_elem *e;
 
-	/* 기부 제거 후 base_priority / donateion_list의 최댓값 비교해
-							우선순위 업데이트해주는 함수*/
-	thread_update_priority();
+		/* mlfqs에서는 대기 중에 미뤄둔 감쇠를 먼저 적용 */
+		if (thread_mlfqs)
+			mlfqs_refresh_waiters(&lock->waiters);
+
+		/* 같은 우선순위 중에서는 먼저 온 스레드 */
+		e = list_min(&lock->waiters, thread_priority_greater, NULL);
+		list_remove(e);
+		thread_unblock(list_entry(e, struct thread, elem));
+	}
+	intr_set_level(old_level);
 
-	sema_up(&lock->semaphore);
+	/* 선점 추가 */
+	thread_preempt();
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -283,16 +378,191 @@ bool lock_held_by_current_thread(const struct lock *lock)
 {
 	ASSERT(lock != NULL);
 
-	return lock->holder == thread_current();
+	return lock_owner(lock) == thread_current();
+}
+
+/* Initializes RW as unheld.  NAME selects the profiling class
+   of the writer lock; see lock_init_named().
+
+   Readers only hold RW->writer for the moment it takes to join
+   RW->reader_list, so they proceed concurrently with each other.
+   A writer keeps RW->writer until rwlock_release_write(), and if
+   readers are still inside when it gets the lock it sleeps on
+   RW->drained until the last one leaves.  Readers that come
+   later block on RW->writer behind it and donate to it as with
+   any lock, and it donates to the readers it waits for through
+   thread_donate_to_readers(). */
+void rwlock_init_named(struct rwlock *rw, const char *name)
+{
+	ASSERT(rw != NULL);
+
+	lock_init_named(&rw->writer, name);
+	rw->readers = 0;
+	list_init(&rw->reader_list);
+	rw->draining = false;
+	sema_init(&rw->drained, 0);
 }
 
-/* One semaphore in a list. */
+/* T의 read_holds 중 RW를 잡고 있는 기록. 없으면 NULL.
+   다른 스레드의 기부가 리스트를 읽으므로 인터럽트를 끄고 본다. */
+static struct rwlock_hold *
+rwlock_find_hold(struct thread *t, const struct rwlock *rw)
+{
+	struct rwlock_hold *found = NULL;
+	enum intr_level old_level = intr_disable();
+	struct list_elem *e;
+
+	for (e = list_begin(&t->read_holds); e != list_end(&t->read_holds);
+		 e = list_next(e))
+	{
+		struct rwlock_hold *hold = list_entry(e, struct rwlock_hold, thread_elem);
+		if (hold->rwlock == rw)
+		{
+			found = hold;
+			break;
+		}
+	}
+	intr_set_level(old_level);
+	return found;
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   is waiting for it.  The current thread must not hold RW
+   already.  If it already holds other rwlocks for reading, the
+   hold record for RW is allocated and this panics if memory is
+   exhausted. */
+void rwlock_acquire_read(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rwlock_find_hold(cur, rw) == NULL);
+	ASSERT(!lock_held_by_current_thread(&rw->writer));
+
+	/* 대부분은 하나만 잡으므로 struct thread 안의 기록을 먼저 쓴다 */
+	hold = &cur->read_hold;
+	if (hold->rwlock != NULL)
+	{
+		hold = malloc(sizeof *hold);
+		if (hold == NULL)
+			PANIC("rwlock_acquire_read: out of memory");
+		hold->rwlock = NULL;
+		hold->thread = cur;
+		hold->boost = PRI_MIN - 1;
+	}
+
+	/* writer가 있거나 기다리는 중이면 여기서 막힌다 */
+	lock_acquire(&rw->writer);
+	old_level = intr_disable();
+	rw->readers++;
+	list_push_back(&rw->reader_list, &hold->elem);
+	list_push_back(&cur->read_holds, &hold->thread_elem);
+	hold->rwlock = rw;
+	intr_set_level(old_level);
+	lock_release(&rw->writer);
+}
+
+/* Releases RW, which the current thread holds for reading. */
+void rwlock_release_read(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+	struct rwlock_hold *hold;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+
+	hold = rwlock_find_hold(cur, rw);
+	ASSERT(hold != NULL);
+
+	old_level = intr_disable();
+	rw->readers--;
+	list_remove(&hold->elem);
+	list_remove(&hold->thread_elem);
+	hold->rwlock = NULL;
+
+	/* RW의 writer에게서 받은 기부만 내려놓는다 */
+	if (hold->boost >= PRI_MIN)
+	{
+		hold->boost = PRI_MIN - 1;
+		thread_update_priority();
+	}
+
+	/* 마지막 reader가 기다리는 writer를 깨운다 */
+	if (rw->readers == 0 && rw->draining)
+	{
+		rw->draining = false;
+		sema_up(&rw->drained);
+	}
+	intr_set_level(old_level);
+
+	if (hold != &cur->read_hold)
+		free(hold);
+	thread_preempt();
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it.  Readers that arrive while we wait are held back. */
+void rwlock_acquire_write(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rwlock_find_hold(cur, rw) == NULL);
+
+	lock_acquire(&rw->writer);
+
+	/* 이미 들어와 있는 reader들이 빠지기를 기부하며 기다린다 */
+	old_level = intr_disable();
+	if (rw->readers > 0)
+	{
+		rw->draining = true;
+		if (!thread_mlfqs)
+			thread_donate_to_readers(rw);
+		sema_down(&rw->drained);
+		cur->draining_rwlock = NULL;
+	}
+	intr_set_level(old_level);
+}
+
+/* Releases RW, which the current thread holds for writing. */
+void rwlock_release_write(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	lock_release(&rw->writer);
+}
+
+/* Returns true if the current thread holds RW for writing. */
+bool rwlock_held_by_current_thread(const struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	return lock_held_by_current_thread(&rw->writer) && rw->readers == 0;
+}
+
+/* One semaphore in a condition variable's waiter heap. */
 struct semaphore_elem
 {
-	struct list_elem elem;		/* List element. */
+	struct pairheap_elem elem;	/* Heap element, ordered by THREAD's priority. */
+	struct list_elem mlfqs_elem; /* Element in mlfqs_waiters (MLFQS only). */
+	struct thread *thread;		/* Waiting thread. */
 	struct semaphore semaphore; /* This semaphore. */
 };
 
+/* condvar 대기자 힙 비교함수 : 대기 스레드의 우선순위가 낮은 쪽이 less.
+   우선순위가 기부 등으로 바뀌면 thread_set_effective_priority()가
+   힙에서의 위치를 고친다. */
+static bool
+semaphore_priority_less(const struct pairheap_elem *a,
+						const struct pairheap_elem *b, void *aux UNUSED)
+{
+	return pairheap_entry(a, struct semaphore_elem, elem)->thread->priority <
+		   pairheap_entry(b, struct semaphore_elem, elem)->thread->priority;
+}
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -300,7 +570,9 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	pairheap_init(&cond->waiters, semaphore_priority_less, NULL);
+	list_init(&cond->mlfqs_waiters);
+	cond->mlfqs_epoch = mlfqs_current_epoch();
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -326,6 +598,8 @@ void cond_init(struct condition *cond)
 void cond_wait(struct condition *cond, struct lock *lock)
 {
 	struct semaphore_elem waiter;
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
@@ -333,23 +607,28 @@ void cond_wait(struct condition *cond, struct lock *lock)
 	ASSERT(lock_held_by_current_thread(lock));
 
 	sema_init(&waiter.semaphore, 0);
-	list_push_back(&cond->waiters, &waiter.elem);
+	waiter.thread = cur;
+
+	/* 대기자의 우선순위는 타이머 인터럽트(mlfqs)에서도 바뀌어
+		힙 위치가 고쳐지므로 힙은 인터럽트를 끄고 다룬다 */
+	old_level = intr_disable();
+	if (thread_mlfqs)
+	{
+		/* cond->mlfqs_epoch가 최신이면 기존 대기자들은 이미 따라잡았으니
+		   새 대기자도 맞춰서 넣는다 */
+		mlfqs_refresh(cur);
+		list_push_back(&cond->mlfqs_waiters, &waiter.mlfqs_elem);
+	}
+	pairheap_push(&cond->waiters, &waiter.elem);
+	cur->waiting_cond = cond;
+	cur->cond_elem = &waiter.elem;
+	intr_set_level(old_level);
 
 	lock_release(lock);
 	sema_down(&waiter.semaphore);
 	lock_acquire(lock);
 }
 
-/* condvar 에서 semaphor_elem 내림차순 정렬을 위한 함수 */
-bool semaphore_priority_greater(const struct list_elem *a,
-								const struct list_elem *b, void *aux)
-{
-	const struct semaphore_elem *t1 = list_entry(a, struct semaphore_elem, elem);
-	const struct semaphore_elem *t2 = list_entry(b, struct semaphore_elem, elem);
-
-	return list_entry(t1->semaphore.waiters.head.next, struct thread, elem)->priority > list_entry(t2->semaphore.waiters.head.next, struct thread, elem)->priority;
-}
-
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -359,19 +638,43 @@ bool semaphore_priority_greater(const struct list_elem *a,
    interrupt handler. */
 void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 {
+	enum intr_level old_level;
+	struct semaphore_elem *waiter;
+
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	old_level = intr_disable();
+	if (pairheap_empty(&cond->waiters))
+	{
+		intr_set_level(old_level);
+		return;
+	}
+
+	/* mlfqs에서는 대기 중에 미뤄둔 감쇠를 먼저 적용.
+		새 우선순위에 맞춰 힙 위치도 함께 고쳐진다.
+		epoch마다 한 번만 훑으므로 broadcast도 대기자당 한 번이다 */
+	if (thread_mlfqs && cond->mlfqs_epoch != mlfqs_current_epoch())
 	{
-		/* waiter_list에서 pop을 하기 전에 sort*/
-		list_sort(&cond->waiters, semaphore_priority_greater, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters),
-							struct semaphore_elem, elem)
-					 ->semaphore);
+		struct list_elem *e;
+
+		for (e = list_begin(&cond->mlfqs_waiters); e != list_end(&cond->mlfqs_waiters);
+			 e = list_next(e))
+			mlfqs_refresh(list_entry(e, struct semaphore_elem, mlfqs_elem)->thread);
+		cond->mlfqs_epoch = mlfqs_current_epoch();
 	}
+
+	/* 가장 높은 우선순위의 대기자를 O(log n)에 꺼낸다 */
+	waiter = pairheap_entry(pairheap_pop(&cond->waiters), struct semaphore_elem, elem);
+	if (thread_mlfqs)
+		list_remove(&waiter->mlfqs_elem);
+	waiter->thread->waiting_cond = NULL;
+	waiter->thread->cond_elem = NULL;
+	intr_set_level(old_level);
+
+	sema_up(&waiter->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -385,6 +688,6 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!pairheap_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
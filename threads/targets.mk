@@ -2,7 +2,11 @@ threads_SRC  = threads/init.c		# Main program.
 threads_SRC += threads/thread.c		# Thread management core.
 threads_SRC += threads/interrupt.c	# Interrupt core.
 threads_SRC += threads/intr-stubs.S	# Interrupt stubs.
+threads_SRC += threads/switch.S		# Thread switch.
 threads_SRC += threads/synch.c		# Synchronization.
+threads_SRC += threads/lockstat.c	# Lock contention profiler.
+threads_SRC += threads/schedtrace.c	# Scheduler event tracer.
+threads_SRC += threads/workqueue.c	# Deferred work queues.
 threads_SRC += threads/palloc.c		# Page allocator.
 threads_SRC += threads/malloc.c		# Subpage allocator.
 threads_SRC += threads/start.S		# Startup code.
@@ -7,9 +7,12 @@
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/schedtrace.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 #include "threads/fixed_point.h"
 #include "intrinsic.h"
 #ifdef USERPROG
@@ -28,21 +31,63 @@
 #define THREAD_BASIC 0xd42df210
 
 /* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-
-/* 모든 스레드의 리스트 */
-static struct list all_list;
+   that are ready to run but not actually running.
+   우선순위별 FIFO 큐 64개 + 비어있지 않은 큐를 표시하는 64비트 비트맵.
+   ready_bitmap의 i번째 비트가 1이면 ready_queues[i]에 스레드가 있다.
+   EDF 스레드는 절대 마감 시각 순 힙인 edf_queue에 따로 들어가며
+   일반 스레드보다 먼저 실행된다.
+   CFS 스케줄러(-cfs)에서는 일반 스레드가 우선순위 큐 대신 가상 실행
+   시간 순 레드블랙 트리인 cfs_queue에 들어간다. */
+static struct list ready_queues[PRI_MAX + 1];
+static uint64_t ready_bitmap;
+static struct pairheap edf_queue;
+static struct rbtree cfs_queue;
+static int64_t cfs_min_vruntime; /* vruntime 하한. 줄지 않는다. */
+static int64_t cfs_load;         /* cfs_queue 스레드들의 가중치 합. */
+static int ready_cnt;            /* ready 상태 스레드 수 (EDF 포함, load_avg 계산용) */
+
+/* 스케줄링 클래스별 상태(EDF 예약, CFS 노드)는 struct thread를 작게
+   유지하기 위해 그 클래스 스레드에만 malloc으로 따로 할당한다.
+   죽은 스레드는 인터럽트가 꺼진 do_schedule()에서 거둬지므로 거기서는
+   free()하지 못하고 dead_edfs/dead_cfss에 모아 두었다가 다음
+   thread_create()가 해제한다. 시작 스레드의 CFS 노드는 malloc이
+   준비되기 전에 필요하므로 initial_cfs를 쓴다. */
+static struct list dead_edfs;
+static struct list dead_cfss;
+static struct cfs_entity initial_cfs;
 
 /* Idle thread. */
 static struct thread *idle_thread;
 
+/* 모든 스레드의 리스트 */
+static struct list all_list;
+
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
+/* 스레드 페이지 재사용 캐시.
+   죽은 스레드의 페이지를 palloc에 돌려주지 않고 최대 PAGE_CACHE_MAX개까지
+   모아 두었다가 thread_create()에서 다시 쓴다. init_thread()가
+   struct thread만 초기화하므로 페이지 전체를 0으로 채울 필요가 없다.
+   인터럽트를 꺼서 보호하며, 메모리가 부족하면 thread_cache_reclaim()으로
+   palloc에 돌려준다. */
+#define PAGE_CACHE_MAX 32
+struct page_cache
+{
+	void *pages[PAGE_CACHE_MAX];
+	size_t cnt;
+};
+static struct page_cache thread_page_cache;
+
+/* tid를 키로 하는 스레드 해시 테이블.
+   thread_by_tid()가 all_list를 순회하지 않도록 한다.
+   해시는 malloc을 쓰므로 인터럽트가 아닌 lock으로 보호한다. */
+static struct hash thread_table;
+static struct lock thread_table_lock;
+
 /* Thread destruction requests */
 static struct list destruction_req;
 
@@ -60,17 +105,146 @@ static unsigned thread_ticks; /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If true, use the completely fair scheduler for normal threads.
+   Controlled by kernel command-line option "-cfs". */
+bool thread_cfs;
+
+/* CFS 스케줄러.
+   -cfs 에서는 일반 스레드를 우선순위 대신 가상 실행 시간(vruntime)으로
+   고른다. 실행 중인 스레드의 vruntime은 틱마다 nice 값에서 얻은 가중치에
+   반비례해 늘어나고, ready 스레드는 vruntime 순 레드블랙 트리에
+   들어가 가장 작은 것부터 실행된다. 그래서 긴 시간 동안 각 스레드가 받는
+   CPU 몫은 가중치에 비례한다.
+   한 번 올라간 스레드는 목표 지연 CFS_LATENCY를 가중치 비율로 나눈 몫만큼
+   실행되며, 몫은 CFS_MIN_GRANULARITY보다 작아지지 않는다. 깨어난 스레드는
+   vruntime이 실행 중인 스레드보다 CFS_WAKEUP_GRANULARITY 넘게 작을 때만
+   선점하고, 오래 잔 스레드는 vruntime 하한에서 CFS_SLEEPER_CREDIT
+   만큼만 앞서도록 당겨진다.
+   EDF 스레드는 그대로 일반 스레드보다 먼저 실행되며, 우선순위 기부는
+   CFS 스레드의 순서에 영향을 주지 않는다. */
+#define CFS_NICE_0_WEIGHT 1024 /* nice 0의 가중치. */
+#define CFS_TICK_VRUNTIME 1024 /* nice 0 스레드가 한 틱 실행할 때 늘어나는 vruntime. */
+#define CFS_LATENCY 12		   /* 목표 지연 (틱). */
+#define CFS_MIN_GRANULARITY 2  /* 한 번에 실행되는 최소 틱 수. */
+#define CFS_WAKEUP_GRANULARITY CFS_TICK_VRUNTIME
+#define CFS_SLEEPER_CREDIT (CFS_LATENCY * CFS_TICK_VRUNTIME / 2)
+
+/* nice NICE_MIN ... NICE_MAX 의 가중치. nice가 1 오를 때마다 약 1.25배씩
+   줄어들어, CPU를 다투는 두 스레드의 nice 차이가 1이면 몫이 약 10%p 차이난다. */
+static const int cfs_nice_weight[NICE_MAX - NICE_MIN + 1] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */ 9548, 7620, 6100, 4904, 3906,
+	/*  -5 */ 3121, 2501, 1991, 1586, 1277,
+	/*   0 */ 1024, 820, 655, 526, 423,
+	/*   5 */ 335, 272, 215, 172, 137,
+	/*  10 */ 110, 87, 70, 56, 45,
+	/*  15 */ 36, 29, 23, 18, 15,
+	/*  20 */ 12,
+};
+
+/* EDF 스케줄링 클래스.
+   EDF 스레드는 thread_create_edf()로 (runtime, period, deadline) 예약과
+   함께 만들어지며, 밀도 합이 EDF_DENSITY_MAX 이하일 때만 허가된다.
+   ready 상태의 EDF 스레드는 절대 마감 시각 순 힙에 들어가고
+   일반 스레드보다 먼저 실행된다. 주기마다 runtime 틱의 예산을 받으며,
+   다 쓰면 다음 릴리스까지 큐 밖에서 기다린다(throttle). 그래서 예약을
+   넘겨 실행하는 스레드가 있어도 다른 스레드의 예약은 지켜진다.
+   EDF 스레드의 priority는 PRI_MAX로, 락을 기다릴 때 소유자에게 기부된다. */
+static int64_t edf_density;	  /* 허가된 EDF 스레드의 밀도 합 (백만분율). */
+static long long edf_job_cnt;  /* 끝난 EDF 작업 수. */
+static long long edf_miss_cnt; /* 그중 마감을 넘긴 수. */
+
 /* mlfq를 위한 load_avg 전역변수 선언*/
 int load_avg;
 
+/* mlfqs 증분 계산.
+   recent_cpu는 1초마다 모든 스레드가 감쇠하지만, 스케줄링에 쓰이는
+   RUNNING/READY 스레드만 그 자리에서 감쇠시키고 BLOCKED 스레드는
+   mlfqs_epoch에 마지막 적용 시점을 남겨두었다가 다시 들여다볼 때
+   (unblock, 세마포어 대기열 정렬 등) 밀린 감쇠를 순서대로 적용한다.
+   초마다의 감쇠 계수는 MLFQS_EPOCHS개까지 링 버퍼에 남겨두고, 그보다
+   오래 밀린 스레드는 lazy_list 앞에서부터 미리 따라잡게 한다.
+   priority는 4틱마다 recent_cpu가 바뀐 스레드(dirty_list)만 다시 계산한다. */
+#define MLFQS_EPOCHS 64
+static int mlfqs_epoch;
+static int mlfqs_decay[MLFQS_EPOCHS];
+static struct list dirty_list; /* priority 재계산 대상 */
+static struct list lazy_list;  /* 감쇠를 미룬 BLOCKED 스레드, epoch 오름차순 */
+
+/* 1초마다의 감쇠 적용은 O(ready 스레드)이므로 인터럽트를 한 번에
+   MLFQS_DECAY_BATCH개 스레드만큼만 끄고 나눠서 한다.
+   decay_pri와 decay_next는 다음 배치가 이어서 볼 ready 큐 위치이다.
+   그 사이 decay_next의 스레드가 큐에서 빠지면 큐 함수들이 다음 원소로
+   넘겨 준다. 그 사이 큐에 들어오는 스레드는 unblock이나 틱에서 이미
+   따라잡았으므로 놓쳐도 된다. */
+#define MLFQS_DECAY_BATCH 16
+static bool decay_active;			/* 감쇠 적용이 진행 중인가? */
+static int decay_pri;				/* 지금 훑는 ready 큐. */
+static struct list_elem *decay_next; /* 그 큐에서 다음에 볼 원소. */
+static long long decay_pass_cnt;	/* 끝낸 감쇠 적용 수. */
+static long long decay_batch_cnt;	/* 그에 쓴 배치 수. */
+static uint64_t decay_batch_max;	/* 가장 긴 배치 (cycles). */
+
+static void mlfqs_mark_dirty(struct thread *t);
+static void mlfqs_recalculate_dirty(struct thread *t);
+
 static void kernel_thread(thread_func *, void *aux);
 
+/* threads/switch.S 의 커널 간 문맥 전환 */
+void switch_threads(uint64_t *cur_rsp, uint64_t next_rsp);
+void switch_entry(void);
+
+/* 새 스레드가 처음 switch_threads()로 전환될 때 스택에서 꺼내는 값.
+   switch_threads()가 push하는 순서의 역순으로 놓인다. */
+struct switch_frame
+{
+	uint64_t r15;
+	uint64_t r14; /* 진입 함수 (kernel_thread) */
+	uint64_t r13; /* 두 번째 인자 */
+	uint64_t r12; /* 첫 번째 인자 */
+	uint64_t rbp;
+	uint64_t rbx;
+	uint64_t rip; /* switch_entry */
+};
+
 static void idle(void *aux UNUSED);
 static struct thread *next_thread_to_run(void);
 static void init_thread(struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
+static uint64_t thread_tid_hash(const struct hash_elem *e, void *aux);
+static bool thread_tid_less(const struct hash_elem *a, const struct hash_elem *b, void *aux);
+static void thread_table_insert(struct thread *t);
+static void *page_cache_get(struct page_cache *cache);
+static bool page_cache_put(struct page_cache *cache, void *page);
+
+/* ready 큐 조작 함수들 */
+static void ready_queue_push(struct thread *t);
+static void ready_queue_remove(struct thread *t);
+static struct thread *ready_queue_pop(void);
+static int ready_queue_max_priority(void);
+static bool is_idle_thread(struct thread *t);
+static void thread_set_effective_priority(struct thread *t, int priority);
+static bool held_lock_less(const struct pairheap_elem *a, const struct pairheap_elem *b, void *aux);
+static void readers_boost(struct rwlock *rw, int priority);
+static tid_t thread_spawn(const char *name, int priority, const struct edf_params *edf,
+						 thread_func *function, void *aux);
+static struct thread *edf_queue_pop(void);
+static bool edf_should_preempt(struct thread *cur);
+static bool edf_deadline_later(const struct pairheap_elem *a, const struct pairheap_elem *b, void *aux);
+static int64_t edf_density_of(int64_t runtime, int64_t period, int64_t deadline);
+static void edf_replenish(void *t_);
+static void account(struct thread *t, uint64_t now);
+static int cfs_weight_of(int nice);
+static void cfs_attach(struct thread *t, struct cfs_entity *cfs);
+static void sched_entity_release(struct thread *t);
+static void sched_entity_reap(void);
+static bool cfs_vruntime_less(const struct rbtree_elem *a, const struct rbtree_elem *b, void *aux);
+static int cfs_slice(struct thread *cur);
+static void cfs_update_min_vruntime(struct thread *cur);
+static struct thread *cfs_preemptor(struct thread *cur);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
@@ -114,16 +288,30 @@ void thread_init(void)
 
 	/* Init the globla thread context */
 	lock_init(&tid_lock);
-	list_init(&ready_list);
+	lock_init(&thread_table_lock);
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init(&ready_queues[i]);
+	ready_bitmap = 0;
+	ready_cnt = 0;
+	pairheap_init(&edf_queue, edf_deadline_later, NULL);
+	rbtree_init(&cfs_queue, cfs_vruntime_less, NULL);
 	list_init(&destruction_req);
+	list_init(&dead_edfs);
+	list_init(&dead_cfss);
 
 	/* all_list 초기화 추가*/
 	list_init(&all_list);
+
+	/* mlfqs 증분 계산용 리스트 초기화 */
+	list_init(&dirty_list);
+	list_init(&lazy_list);
 	console_file_init(); // 콘솔 가짜파일 초기화
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread();
 	init_thread(initial_thread, "main", PRI_DEFAULT);
+	if (thread_cfs)
+		cfs_attach(initial_thread, &initial_cfs);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid();
 }
@@ -138,8 +326,17 @@ void thread_start(void)
 
 	/* load_avg 전역변수 초기화 */
 	load_avg = LOAD_AVG_DEFAULT;
+
+	/* 해시 테이블은 malloc이 준비된 뒤에 만들 수 있다 */
+	if (!hash_init(&thread_table, thread_tid_hash, thread_tid_less, NULL))
+		PANIC("thread_start: cannot init thread_table");
+	thread_table_insert(initial_thread);
+
 	thread_create("idle", PRI_MIN, idle, &idle_started);
 
+	/* 인터럽트에서 미룬 일을 받을 워커 스레드들 */
+	workqueue_init();
+
 	/* Start preemptive thread scheduling. */
 	intr_enable();
 
@@ -154,7 +351,7 @@ void thread_tick(void)
 	struct thread *t = thread_current();
 
 	/* Update statistics. */
-	if (t == idle_thread)
+	if (is_idle_thread(t))
 		idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
@@ -163,6 +360,29 @@ void thread_tick(void)
 	else
 		kernel_ticks++;
 
+	/* EDF 스레드는 이번 주기의 예산을 다 쓰면 다음 릴리스까지 쉰다 */
+	if (t->edf && !t->edf->throttled && --t->edf->budget <= 0)
+	{
+		int64_t release = t->edf->release + t->edf->period;
+
+		if (release <= timer_ticks())
+			release = timer_ticks() + 1;
+		t->edf->throttled = true;
+		timer_add(&t->edf->timer, release);
+		intr_yield_on_return();
+		return;
+	}
+
+	/* CFS 스레드는 가중치에 반비례해 vruntime이 늘고, 몫을 다 쓰면 양보한다 */
+	if (thread_cfs && !t->edf && !is_idle_thread(t))
+	{
+		t->cfs->vruntime += CFS_TICK_VRUNTIME * CFS_NICE_0_WEIGHT / t->cfs->weight;
+		cfs_update_min_vruntime(t);
+		if (++thread_ticks >= (unsigned)cfs_slice(t))
+			intr_yield_on_return();
+		return;
+	}
+
 	/* Enforce preemption. */
 	if (++thread_ticks >= TIME_SLICE)
 		intr_yield_on_return();
@@ -173,6 +393,13 @@ void thread_print_stats(void)
 {
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 		   idle_ticks, kernel_ticks, user_ticks);
+	if (edf_job_cnt > 0)
+		printf("EDF: %lld jobs, %lld deadline misses\n", edf_job_cnt, edf_miss_cnt);
+	if (timer_tickless)
+		printf("Tickless: %lld timer wakeups saved\n", timer_wakeups_saved());
+	if (decay_pass_cnt > 0)
+		printf("MLFQS decay: %lld passes, %lld batches, max %llu cycles per batch\n",
+			   decay_pass_cnt, decay_batch_cnt, decay_batch_max);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -192,44 +419,120 @@ void thread_print_stats(void)
    Priority scheduling is the goal of Problem 1-3. */
 tid_t thread_create(const char *name, int priority,
 					thread_func *function, void *aux)
+{
+	return thread_spawn(name, priority, NULL, function, aux);
+}
+
+/* EDF 예약을 가진 스레드 NAME을 만들어 FUNCTION(AUX)를 실행한다.
+   첫 작업은 지금 릴리스되며, 작업을 마칠 때마다 thread_edf_wait()를
+   불러 다음 릴리스를 기다려야 한다. 예약이 잘못되었거나 허가하면
+   EDF 스레드들의 밀도 합이 EDF_DENSITY_MAX를 넘으면 TID_ERROR. */
+tid_t thread_create_edf(const char *name, const struct edf_params *edf,
+						thread_func *function, void *aux)
+{
+	enum intr_level old_level;
+	int64_t density;
+	tid_t tid;
+
+	ASSERT(edf != NULL);
+
+	if (edf->runtime <= 0 || edf->runtime > edf->deadline || edf->period <= 0)
+		return TID_ERROR;
+	density = edf_density_of(edf->runtime, edf->period, edf->deadline);
+
+	/* 허가 검사 */
+	old_level = intr_disable();
+	if (edf_density + density > EDF_DENSITY_MAX)
+	{
+		intr_set_level(old_level);
+		return TID_ERROR;
+	}
+	edf_density += density;
+	intr_set_level(old_level);
+
+	tid = thread_spawn(name, PRI_MAX, edf, function, aux);
+	if (tid == TID_ERROR)
+	{
+		old_level = intr_disable();
+		edf_density -= density;
+		intr_set_level(old_level);
+	}
+	return tid;
+}
+
+/* thread_create()와 thread_create_edf()의 공통부분.
+   EDF가 NULL이 아니면 EDF 스레드로 만든다. */
+static tid_t
+thread_spawn(const char *name, int priority, const struct edf_params *edf,
+			 thread_func *function, void *aux)
 {
 	struct thread *t;
+	struct edf_entity *edf_ent = NULL;
+	struct cfs_entity *cfs_ent = NULL;
 	tid_t tid;
 
 	ASSERT(function != NULL);
 
-	/* Allocate thread. */
-	t = palloc_get_page(PAL_ZERO);
+	/* 죽은 스레드들이 남긴 클래스 상태를 먼저 돌려준다 */
+	sched_entity_reap();
+
+	/* 클래스 상태는 그 클래스 스레드에만 따로 할당한다 */
+	if (edf != NULL && (edf_ent = malloc(sizeof *edf_ent)) == NULL)
+		return TID_ERROR;
+	if (thread_cfs && (cfs_ent = malloc(sizeof *cfs_ent)) == NULL)
+	{
+		free(edf_ent);
+		return TID_ERROR;
+	}
+
+	/* Allocate thread. 캐시된 페이지가 있으면 재사용 */
+	t = page_cache_get(&thread_page_cache);
 	if (t == NULL)
+		t = palloc_get_page(0);
+	if (t == NULL)
+	{
+		free(edf_ent);
+		free(cfs_ent);
 		return TID_ERROR;
+	}
 
 	/* Initialize thread. */
 	init_thread(t, name, priority);
 	tid = t->tid = allocate_tid();
+	if (cfs_ent != NULL)
+		cfs_attach(t, cfs_ent);
 
-	/* fd 테이블을 동적 페이지로 할당 */
-	t->fd_table = palloc_get_page(PAL_ZERO);
-	if (t->fd_table == NULL)
-	{
-		/* palloc 실패 시, 구조체 페이지도 돌려주고 에러 처리 */
-		palloc_free_page(t);
-		return TID_ERROR;
-	}
-	/* fd 테이블은 palloc_zero된 페이지라 이미 NULL로 초기화됨 */
-	t->fd_table[0] = &console_in;
-	t->fd_table[1] = &console_out;
-	t->next_fd = 2; /* 0: stdin, 1: stdout 예약 */
+	/* 실행되기 전에 tid로 찾을 수 있게 등록 */
+	thread_table_insert(t);
+	schedtrace_name(t);
+	schedtrace(SCHEDTRACE_CREATE, t, thread_current()->tid);
 
 	/* Call the kernel_thread if it scheduled.
-	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
-	t->tf.rip = (uintptr_t)kernel_thread;
-	t->tf.R.rdi = (uint64_t)function;
-	t->tf.R.rsi = (uint64_t)aux;
-	t->tf.ds = SEL_KDSEG;
-	t->tf.es = SEL_KDSEG;
-	t->tf.ss = SEL_KDSEG;
-	t->tf.cs = SEL_KCSEG;
-	t->tf.eflags = FLAG_IF;
+	 * switch_threads() pops this frame and returns to switch_entry,
+	 * which calls kernel_thread(function, aux). The frame ends 16 bytes
+	 * below the top of the page so that the call is 16-byte aligned. */
+	struct switch_frame *sf =
+		(struct switch_frame *)((uint8_t *)t + PGSIZE - 16) - 1;
+	memset(sf, 0, sizeof *sf);
+	sf->r14 = (uint64_t)kernel_thread;
+	sf->r12 = (uint64_t)function;
+	sf->r13 = (uint64_t)aux;
+	sf->rip = (uint64_t)switch_entry;
+	t->switch_rsp = (uint64_t)sf;
+
+	if (edf_ent != NULL)
+	{
+		memset(edf_ent, 0, sizeof *edf_ent);
+		edf_ent->thread = t;
+		edf_ent->runtime = edf->runtime;
+		edf_ent->period = edf->period;
+		edf_ent->deadline = edf->deadline;
+		edf_ent->release = timer_ticks();
+		edf_ent->abs_deadline = edf_ent->release + edf->deadline;
+		edf_ent->budget = edf->runtime;
+		timer_event_init(&edf_ent->timer, edf_replenish, t);
+		t->edf = edf_ent;
+	}
 
 	/* Add to run queue. */
 	thread_unblock(t);
@@ -250,7 +553,17 @@ void thread_block(void)
 {
 	ASSERT(!intr_context());
 	ASSERT(intr_get_level() == INTR_OFF);
-	thread_current()->status = THREAD_BLOCKED;
+
+	struct thread *cur = thread_current();
+
+	/* block 되는 동안은 recent_cpu 감쇠를 미룬다 */
+	if (thread_mlfqs && !is_idle_thread(cur))
+	{
+		cur->mlfqs_lazy = true;
+		list_push_back(&lazy_list, &cur->lazy_elem);
+	}
+	cur->status = THREAD_BLOCKED;
+	schedtrace(SCHEDTRACE_BLOCK, cur, 0);
 	schedule();
 }
 
@@ -285,8 +598,8 @@ bool thread_priority_greater(const struct list_elem *a,
 // 	intr_set_level(old_level);
 // }
 /*
-	list_insert_ordered() : 삽입 시 정렬을 유지하면서 삽입
-	thread_priority_greater : 내림차순 정렬을 위한 함수
+	ready_queue_push() : 자기 우선순위 큐의 맨 뒤에 O(1)로 삽입
+						같은 우선순위 안에서는 FIFO 순서 유지
 	intr_yield_on_return() : 타이머 irq 컨텍스트에서도
 							안전하게 다음에 스케줄링 하도록 예약
 */
@@ -298,27 +611,87 @@ void thread_unblock(struct thread *t)
 
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
-	// list_push_back(&ready_list, &t->elem);
-	list_insert_ordered(&ready_list, &t->elem, thread_priority_greater, NULL);
+
+	/* 밀린 감쇠를 적용해 올바른 우선순위 큐에 들어가게 한다 */
+	if (thread_mlfqs)
+	{
+		mlfqs_refresh(t);
+		if (t->mlfqs_lazy)
+		{
+			list_remove(&t->lazy_elem);
+			t->mlfqs_lazy = false;
+		}
+	}
+	/* 오래 잔 스레드가 밀린 몫을 한꺼번에 가져가지 못하게 한다 */
+	if (thread_cfs && t->cfs->vruntime < cfs_min_vruntime - CFS_SLEEPER_CREDIT)
+		t->cfs->vruntime = cfs_min_vruntime - CFS_SLEEPER_CREDIT;
+	ready_queue_push(t);
 	t->status = THREAD_READY;
+	t->ready_stamp = rdtsc();
+	/* 인터럽트가 깨웠으면 깨운 스레드는 0 */
+	schedtrace(SCHEDTRACE_UNBLOCK, t, intr_context() ? 0 : thread_current()->tid);
 	intr_set_level(old_level);
 
 	/* 우선순위 선점은 절대로 unblock 함수 내에서 수행 되면 안된다. */
 	// thread_preempt();
 }
 
-/* 더 높은 우선순위면 선점 예약/실행 */
+/* ready EDF 스레드가 현재 스레드를 선점해야 하면 선점 예약/실행하고 true.
+   EDF 선점은 mlfqs와 상관없이 검사해야 하므로 따로 둔다. */
+bool thread_preempt_edf(void)
+{
+	enum intr_level old_level = intr_disable();
+	bool preempt = edf_should_preempt(thread_current());
+
+	intr_set_level(old_level);
+	if (!preempt)
+		return false;
+	if (intr_context())
+		intr_yield_on_return();
+	else
+		thread_yield();
+	return true;
+}
+
+/* 더 높은 우선순위면 선점 예약/실행.
+   큐를 검사하는 사이에 타이머 선점으로 큐가 바뀌지 않도록 검사는
+   인터럽트를 끄고 한다. */
 void thread_preempt(void)
 {
-	if (list_empty(&ready_list))
+	enum intr_level old_level;
+	int max_pri;
+
+	if (thread_preempt_edf())
+		return;
+
+	/* CFS에서는 vruntime이 충분히 뒤처진 스레드만 선점한다 */
+	if (thread_cfs)
 	{
+		struct thread *t;
+
+		old_level = intr_disable();
+		t = cfs_preemptor(thread_current());
+		if (t != NULL)
+			schedtrace(SCHEDTRACE_PREEMPT, thread_current(), t->priority);
+		intr_set_level(old_level);
+
+		if (t != NULL)
+		{
+			if (intr_context())
+				intr_yield_on_return();
+			else
+				thread_yield();
+		}
 		return;
 	}
-	struct list_elem *e = list_begin(&ready_list);
-	struct thread *t = list_entry(e, struct thread, elem);
 
-	if (t->priority > thread_get_priority())
+	old_level = intr_disable();
+	max_pri = ready_bitmap != 0 ? ready_queue_max_priority() : PRI_MIN - 1;
+	intr_set_level(old_level);
+
+	if (max_pri > thread_get_priority())
 	{
+		schedtrace(SCHEDTRACE_PREEMPT, thread_current(), max_pri);
 		if (intr_context())
 			intr_yield_on_return();
 		else
@@ -373,11 +746,27 @@ void thread_exit(void)
 	/* all_list에서 스레드 제거 */
 	list_remove(&thread_current()->allelem);
 
-	/* fd_table 페이지 해제 */
-	palloc_free_page(thread_current()->fd_table);
-	thread_current()->fd_table = NULL;
+	/* thread_table에서 제거 */
+	lock_acquire(&thread_table_lock);
+	hash_delete(&thread_table, &thread_current()->tid_elem);
+	lock_release(&thread_table_lock);
 
 	intr_disable();
+	/* EDF 예약을 돌려준다 */
+	if (thread_current()->edf)
+	{
+		struct thread *cur = thread_current();
+
+		timer_cancel(&cur->edf->timer);
+		edf_density -= edf_density_of(cur->edf->runtime, cur->edf->period,
+									  cur->edf->deadline);
+	}
+	/* 페이지가 해제되기 전에 dirty 리스트에서 빼준다 */
+	if (thread_current()->mlfqs_dirty)
+	{
+		list_remove(&thread_current()->dirty_elem);
+		thread_current()->mlfqs_dirty = false;
+	}
 	do_schedule(THREAD_DYING);
 	NOT_REACHED();
 }
@@ -405,10 +794,9 @@ void thread_yield(void)
 	ASSERT(!intr_context());
 
 	old_level = intr_disable();
-	if (curr != idle_thread)
+	if (!is_idle_thread(curr))
 	{
-		// list_push_back(&ready_list, &curr->elem);
-		list_insert_ordered(&ready_list, &curr->elem, thread_priority_greater, NULL);
+		ready_queue_push(curr);
 	}
 	do_schedule(THREAD_READY);
 	intr_set_level(old_level);
@@ -420,11 +808,21 @@ void thread_yield(void)
 */
 void thread_set_priority(int new_priority)
 {
-	enum intr_level old = intr_disable();
+	enum intr_level old;
+
+	/* EDF 스레드는 마감 순으로 실행되므로 우선순위가 없다 */
+	if (thread_current()->edf)
+		return;
+
+	old = intr_disable();
 
 	thread_current()->base_priority = new_priority;
 	thread_update_priority();
 
+	/* mlfqs에서는 다음 4틱 재계산 때 원래 값으로 돌아가야 한다 */
+	if (thread_mlfqs)
+		mlfqs_mark_dirty(thread_current());
+
 	intr_set_level(old);
 
 	thread_preempt();
@@ -443,6 +841,8 @@ void thread_set_nice(int nice UNUSED)
 	// 현재 스레드의 nice 값을 새 값으로 설정
 	enum intr_level old_level = intr_disable();
 	thread_current()->nice = nice;
+	if (thread_current()->cfs != NULL)
+		thread_current()->cfs->weight = cfs_weight_of(nice);
 	mlfqs_calculate_priority(thread_current());
 	thread_preempt();
 	intr_set_level(old_level);
@@ -476,6 +876,7 @@ int thread_get_recent_cpu(void)
 	/* TODO: Your implementation goes here */
 	// 현재 스레드의 recent_cpu * 100 값을 반환
 	enum intr_level old_level = intr_disable();
+	mlfqs_refresh(thread_current());
 	int recent_cpu = fp_to_int_round(mult_mixed(thread_current()->recent_cpu, 100));
 	intr_set_level(old_level);
 	return recent_cpu;
@@ -504,6 +905,9 @@ idle(void *idle_started_ UNUSED)
 		intr_disable();
 		thread_block();
 
+		/* tickless 모드면 다음 타이머 만료까지 틱 인터럽트를 끈다 */
+		timer_idle_enter();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -543,19 +947,30 @@ init_thread(struct thread *t, const char *name, int priority)
 	memset(t, 0, sizeof *t);
 	t->status = THREAD_BLOCKED;
 	strlcpy(t->name, name, sizeof t->name);
-	t->tf.rsp = (uint64_t)t + PGSIZE - sizeof(void *);
 	t->priority = priority;
 	t->magic = THREAD_MAGIC;
 
+	t->acct_stamp = rdtsc();
+
 	/* priority donate를 위한 변수들 초기화*/
 	t->base_priority = priority;
-	list_init(&t->donation_list);
+	pairheap_init(&t->held_locks, held_lock_less, NULL);
 	t->waiting_lock = NULL;
+	list_init(&t->read_holds);
+	t->read_hold.rwlock = NULL;
+	t->read_hold.thread = t;
+	t->read_hold.boost = PRI_MIN - 1;
+	t->draining_rwlock = NULL;
 
 	/* mlfqs를 위한 변수들 초기화 */
 	t->nice = NICE_DEFAULT;
 	t->recent_cpu = RECENT_CPU_DEFAULT;
 
+	/* 새 스레드는 다음 4틱 재계산 때 priority가 정해져야 한다 */
+	t->mlfqs_epoch = mlfqs_epoch;
+	if (thread_mlfqs)
+		mlfqs_mark_dirty(t);
+
 	/* userprog 종료상태 변수 초기화 */
 	t->exit_status = -1;
 
@@ -563,7 +978,10 @@ init_thread(struct thread *t, const char *name, int priority)
 	t->parent_tid = TID_ERROR;
 	list_init(&t->children);
 
-	t->fd_table = NULL;
+#ifdef USERPROG
+	/* fd 테이블은 struct thread 안의 슬롯으로 시작한다 */
+	fd_table_init(&t->fd_table);
+#endif
 
 	/* 스레드 등록 코드 추가
 	 allelem은 struct thread에 있어야 함
@@ -579,15 +997,315 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
+	struct thread *t = edf_queue_pop();
+
+	if (t == NULL)
+		t = ready_queue_pop();
+	return t != NULL ? t : idle_thread;
+}
+
+/* T가 idle 스레드인지 */
+static bool
+is_idle_thread(struct thread *t)
+{
+	return t == idle_thread;
+}
+
+/* ready 큐 조작 함수들. 인터럽트를 꺼서 보호한다. */
+
+/* T를 우선순위 큐 맨 뒤에 넣고 비트맵에 표시 */
+static void
+ready_queue_push(struct thread *t)
+{
+	enum intr_level old_level;
+
+	ASSERT(PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	old_level = intr_disable();
+	if (t->edf)
+	{
+		/* 예산을 다 쓴 EDF 스레드는 다음 릴리스까지 큐 밖에 둔다 */
+		if (t->edf->throttled)
+			t->edf->parked = true;
+		else
+			pairheap_push(&edf_queue, &t->edf->elem);
+	}
+	else if (thread_cfs)
+	{
+		rbtree_insert(&cfs_queue, &t->cfs->elem);
+		cfs_load += t->cfs->weight;
+	}
 	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	{
+		list_push_back(&ready_queues[t->priority], &t->elem);
+		ready_bitmap |= 1ULL << t->priority;
+	}
+	ready_cnt++;
+	intr_set_level(old_level);
+}
+
+/* ready 상태인 T를 큐에서 빼고, 큐가 비면 비트맵 비트를 지움 */
+static void
+ready_queue_remove(struct thread *t)
+{
+	enum intr_level old_level;
+
+	ASSERT(t->status == THREAD_READY);
+
+	old_level = intr_disable();
+	if (!t->edf && thread_cfs)
+	{
+		rbtree_remove(&cfs_queue, &t->cfs->elem);
+		cfs_load -= t->cfs->weight;
+	}
+	else if (!t->edf)
+	{
+		if (decay_next == &t->elem)
+			decay_next = list_next(decay_next);
+		list_remove(&t->elem);
+		if (list_empty(&ready_queues[t->priority]))
+			ready_bitmap &= ~(1ULL << t->priority);
+	}
+	else if (t->edf->parked)
+		t->edf->parked = false;
+	else
+		pairheap_remove(&edf_queue, &t->edf->elem);
+	ready_cnt--;
+	intr_set_level(old_level);
+}
+
+/* 가장 높은 우선순위 큐의 맨 앞 스레드를 꺼내 반환.
+   CFS에서는 vruntime이 가장 작은 스레드를 꺼낸다.
+   큐가 모두 비어 있으면 NULL */
+static struct thread *
+ready_queue_pop(void)
+{
+	struct thread *t = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	if (thread_cfs)
+	{
+		if (!rbtree_empty(&cfs_queue))
+		{
+			t = rbtree_entry(rbtree_pop_first(&cfs_queue), struct cfs_entity, elem)->thread;
+			cfs_load -= t->cfs->weight;
+			if (t->cfs->vruntime > cfs_min_vruntime)
+				cfs_min_vruntime = t->cfs->vruntime;
+			ready_cnt--;
+		}
+	}
+	else if (ready_bitmap != 0)
+	{
+		int pri = ready_queue_max_priority();
+		if (decay_next == list_front(&ready_queues[pri]))
+			decay_next = list_next(decay_next);
+		t = list_entry(list_pop_front(&ready_queues[pri]), struct thread, elem);
+		if (list_empty(&ready_queues[pri]))
+			ready_bitmap &= ~(1ULL << pri);
+		ready_cnt--;
+	}
+	intr_set_level(old_level);
+	return t;
+}
+
+/* edf_queue에서 마감이 가장 이른 스레드를 꺼내 반환. 비어 있으면 NULL */
+static struct thread *
+edf_queue_pop(void)
+{
+	struct thread *t = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	if (!pairheap_empty(&edf_queue))
+	{
+		t = pairheap_entry(pairheap_pop(&edf_queue), struct edf_entity, elem)->thread;
+		ready_cnt--;
+	}
+	intr_set_level(old_level);
+	return t;
+}
+
+/* ready 큐 중 가장 높은 우선순위. 비트맵이 비어있으면 안 됨.
+   최상위 1비트 위치 = 63 - (앞쪽 0비트 개수) */
+static int
+ready_queue_max_priority(void)
+{
+	ASSERT(ready_bitmap != 0);
+	return PRI_MAX - __builtin_clzll(ready_bitmap);
+}
+
+/* ready EDF 스레드가 실행 중인 CUR를 선점해야 하는지.
+   EDF 스레드는 일반 스레드와 예산을 다 쓴 EDF 스레드를 항상 선점하고,
+   EDF 스레드끼리는 마감이 더 이른 쪽이 선점한다. */
+static bool
+edf_should_preempt(struct thread *cur)
+{
+	struct pairheap_elem *top = pairheap_top(&edf_queue);
+
+	if (top == NULL)
+		return false;
+	if (!cur->edf || cur->edf->throttled)
+		return true;
+	return pairheap_entry(top, struct edf_entity, elem)->abs_deadline <
+		   cur->edf->abs_deadline;
+}
+
+/* 새 스레드 T에 CFS 노드 CFS를 붙인다. vruntime 하한에서 시작한다 */
+static void
+cfs_attach(struct thread *t, struct cfs_entity *cfs)
+{
+	cfs->thread = t;
+	cfs->weight = cfs_weight_of(NICE_DEFAULT);
+	cfs->vruntime = cfs_min_vruntime;
+	t->cfs = cfs;
+}
+
+/* 거둬지는 스레드 T의 클래스 상태를 해제 대기 리스트로 넘긴다.
+   인터럽트가 꺼진 채 불린다. */
+static void
+sched_entity_release(struct thread *t)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (t->edf != NULL)
+		list_push_back(&dead_edfs, &t->edf->free_elem);
+	if (t->cfs != NULL && t->cfs != &initial_cfs)
+		list_push_back(&dead_cfss, &t->cfs->free_elem);
+}
+
+/* 해제 대기 중인 클래스 상태들을 free()한다 */
+static void
+sched_entity_reap(void)
+{
+	for (;;)
+	{
+		enum intr_level old_level = intr_disable();
+		void *p = NULL;
+
+		if (!list_empty(&dead_edfs))
+			p = list_entry(list_pop_front(&dead_edfs), struct edf_entity, free_elem);
+		else if (!list_empty(&dead_cfss))
+			p = list_entry(list_pop_front(&dead_cfss), struct cfs_entity, free_elem);
+		intr_set_level(old_level);
+		if (p == NULL)
+			break;
+		free(p);
+	}
+}
+
+/* NICE 값의 CFS 가중치. 범위를 벗어난 값은 가장 가까운 끝으로 본다. */
+static int
+cfs_weight_of(int nice)
+{
+	if (nice < NICE_MIN)
+		nice = NICE_MIN;
+	if (nice > NICE_MAX)
+		nice = NICE_MAX;
+	return cfs_nice_weight[nice - NICE_MIN];
+}
+
+/* cfs_queue 트리 비교함수. vruntime 오름차순 */
+static bool
+cfs_vruntime_less(const struct rbtree_elem *a, const struct rbtree_elem *b,
+				  void *aux UNUSED)
+{
+	return rbtree_entry(a, struct cfs_entity, elem)->vruntime <
+		   rbtree_entry(b, struct cfs_entity, elem)->vruntime;
+}
+
+/* 실행 중인 CFS 스레드 CUR가 한 번 올라가서 실행할 틱 수.
+   목표 지연을 ready 스레드들과 CUR의 가중치 비율로 나눈다.
+   스레드가 많아 몫이 CFS_MIN_GRANULARITY보다 작아지면 주기를 늘린다. */
+static int
+cfs_slice(struct thread *cur)
+{
+	int64_t nr = rbtree_size(&cfs_queue) + 1;
+	int64_t period = CFS_LATENCY;
+	int64_t slice;
+
+	if (nr * CFS_MIN_GRANULARITY > period)
+		period = nr * CFS_MIN_GRANULARITY;
+	slice = period * cur->cfs->weight / (cfs_load + cur->cfs->weight);
+	return slice > CFS_MIN_GRANULARITY ? slice : CFS_MIN_GRANULARITY;
+}
+
+/* vruntime 하한을 실행 중인 CUR와 트리의 맨 앞 중 작은 값까지
+   올린다. 하한은 줄지 않으며, 깨어난 스레드와 옮겨 온 스레드의
+   vruntime 기준이 된다. */
+static void
+cfs_update_min_vruntime(struct thread *cur)
+{
+	int64_t vruntime = cur->cfs->vruntime;
+	struct rbtree_elem *first;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	first = rbtree_first(&cfs_queue);
+	if (first != NULL)
+	{
+		int64_t v = rbtree_entry(first, struct cfs_entity, elem)->vruntime;
+
+		if (v < vruntime)
+			vruntime = v;
+	}
+	if (vruntime > cfs_min_vruntime)
+		cfs_min_vruntime = vruntime;
+	intr_set_level(old_level);
+}
+
+/* 실행 중인 CUR를 선점해야 할 ready CFS 스레드. 없으면 NULL.
+   idle 스레드와 예산을 다 쓴 EDF 스레드는 항상 선점되고, 다른 EDF
+   스레드는 선점되지 않는다. CFS 스레드끼리는 vruntime이
+   CFS_WAKEUP_GRANULARITY 넘게 뒤처진 쪽이 선점한다. */
+static struct thread *
+cfs_preemptor(struct thread *cur)
+{
+	struct rbtree_elem *first = rbtree_first(&cfs_queue);
+	struct thread *t;
+
+	if (first == NULL)
+		return NULL;
+	t = rbtree_entry(first, struct cfs_entity, elem)->thread;
+	if (is_idle_thread(cur) || (cur->edf && cur->edf->throttled))
+		return t;
+	if (cur->edf)
+		return NULL;
+	return cur->cfs->vruntime - t->cfs->vruntime > CFS_WAKEUP_GRANULARITY ? t : NULL;
+}
+
+/* T의 실효 우선순위를 PRIORITY로 바꾼다.
+   T가 ready 큐에 있으면 새 우선순위 큐의 맨 뒤로 O(1)에 옮긴다.
+   condvar를 기다리는 중이면 대기자 힙에서의 위치를 O(log n)에 고친다. */
+static void
+thread_set_effective_priority(struct thread *t, int priority)
+{
+	enum intr_level old_level;
+
+	if (t->priority == priority)
+		return;
+
+	old_level = intr_disable();
+	if (t->status == THREAD_READY)
+	{
+		ready_queue_remove(t);
+		t->priority = priority;
+		ready_queue_push(t);
+	}
+	else
+		t->priority = priority;
+	if (t->waiting_cond != NULL)
+		pairheap_update(&t->waiting_cond->waiters, t->cond_elem);
+	intr_set_level(old_level);
 }
 
 /* Use iretq to launch the thread */
 void do_iret(struct intr_frame *tf)
 {
+	/* 유저 프로세스를 처음 시작할 때는 여기서 유저 모드로 나간다 */
+	if ((tf->cs & 3) == 3)
+		thread_account_leave();
+
 	__asm __volatile(
 		"movq %0, %%rsp\n"
 		"movq 0(%%rsp),%%r15\n"
@@ -626,60 +1344,12 @@ void do_iret(struct intr_frame *tf)
 static void
 thread_launch(struct thread *th)
 {
-	uint64_t tf_cur = (uint64_t)&running_thread()->tf;
-	uint64_t tf = (uint64_t)&th->tf;
 	ASSERT(intr_get_level() == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile(
-		/* Store registers that will be used. */
-		"push %%rax\n"
-		"push %%rbx\n"
-		"push %%rcx\n"
-		/* Fetch input once */
-		"movq %0, %%rax\n"
-		"movq %1, %%rcx\n"
-		"movq %%r15, 0(%%rax)\n"
-		"movq %%r14, 8(%%rax)\n"
-		"movq %%r13, 16(%%rax)\n"
-		"movq %%r12, 24(%%rax)\n"
-		"movq %%r11, 32(%%rax)\n"
-		"movq %%r10, 40(%%rax)\n"
-		"movq %%r9, 48(%%rax)\n"
-		"movq %%r8, 56(%%rax)\n"
-		"movq %%rsi, 64(%%rax)\n"
-		"movq %%rdi, 72(%%rax)\n"
-		"movq %%rbp, 80(%%rax)\n"
-		"movq %%rdx, 88(%%rax)\n"
-		"pop %%rbx\n" // Saved rcx
-		"movq %%rbx, 96(%%rax)\n"
-		"pop %%rbx\n" // Saved rbx
-		"movq %%rbx, 104(%%rax)\n"
-		"pop %%rbx\n" // Saved rax
-		"movq %%rbx, 112(%%rax)\n"
-		"addq $120, %%rax\n"
-		"movw %%es, (%%rax)\n"
-		"movw %%ds, 8(%%rax)\n"
-		"addq $32, %%rax\n"
-		"call __next\n" // read the current rip.
-		"__next:\n"
-		"pop %%rbx\n"
-		"addq $(out_iret -  __next), %%rbx\n"
-		"movq %%rbx, 0(%%rax)\n" // rip
-		"movw %%cs, 8(%%rax)\n"	 // cs
-		"pushfq\n"
-		"popq %%rbx\n"
-		"mov %%rbx, 16(%%rax)\n" // eflags
-		"mov %%rsp, 24(%%rax)\n" // rsp
-		"movw %%ss, 32(%%rax)\n"
-		"mov %%rcx, %%rdi\n"
-		"call do_iret\n"
-		"out_iret:\n"
-		: : "g"(tf_cur), "g"(tf) : "memory");
+	/* Both threads are in the kernel here, so saving the callee-saved
+	 * registers and the stack pointer is enough. Entering user mode
+	 * still goes through do_iret(). */
+	switch_threads(&running_thread()->switch_rsp, th->switch_rsp);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -695,7 +1365,9 @@ do_schedule(int status)
 	{
 		struct thread *victim =
 			list_entry(list_pop_front(&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		sched_entity_release(victim);
+		if (!page_cache_put(&thread_page_cache, victim))
+			palloc_free_page(victim);
 	}
 	thread_current()->status = status;
 	schedule();
@@ -723,6 +1395,24 @@ schedule(void)
 
 	if (curr != next)
 	{
+		uint64_t now = rdtsc();
+
+		schedtrace(SCHEDTRACE_SWITCH, curr, next->tid);
+
+		/* CPU 사용량 계정 : 잠들며 물러나면 자발적, ready로 물러나면 비자발적 */
+		account(curr, now);
+		if (curr->status == THREAD_BLOCKED)
+			curr->usage.nvcsw++;
+		else if (curr->status == THREAD_READY)
+		{
+			curr->usage.nivcsw++;
+			curr->ready_stamp = now;
+		}
+		if (next->ready_stamp != 0)
+			next->usage.wtime += now - next->ready_stamp;
+		next->ready_stamp = 0;
+		next->acct_stamp = now;
+
 		/* If the thread we switched from is dying, destroy its struct
 		   thread. This must happen late so that thread_exit() doesn't
 		   pull out the rug under itself.
@@ -756,104 +1446,367 @@ allocate_tid(void)
 	return tid;
 }
 
-/* donate를 위한 함수 구현부*/
-void thread_donate_priority(void)
+/* donate를 위한 함수 구현부
+
+	기부는 두 단계의 힙으로 관리한다.
+	- lock->donors : 그 락을 기다리는 스레드들의 우선순위 최대 힙
+	- thread->held_locks : 스레드가 가진 락들의 힙.
+	  키는 각 락의 최고 대기자 우선순위 (lock_donation())
+	스레드의 실효 우선순위는 max(base_priority, held_locks의 top 키)이므로
+	힙 하나를 갱신하는 O(log n)으로 다시 계산된다. */
+
+/* LOCK이 소유자에게 기부하는 우선순위. 대기자가 없으면 PRI_MIN - 1 */
+static int
+lock_donation(const struct lock *lock)
+{
+	struct pairheap_elem *top = pairheap_top(&lock->donors);
+
+	if (top == NULL)
+		return PRI_MIN - 1;
+	return pairheap_entry(top, struct thread, donation_elem)->priority;
+}
+
+/* lock->donors 힙 비교함수 : 우선순위가 낮은 쪽이 less */
+bool thread_donor_less(const struct pairheap_elem *a, const struct pairheap_elem *b,
+					   void *aux UNUSED)
 {
-	enum intr_level old_level = intr_disable();
+	return pairheap_entry(a, struct thread, donation_elem)->priority <
+		   pairheap_entry(b, struct thread, donation_elem)->priority;
+}
 
-	struct thread *cur = thread_current();
-	struct lock *lock = cur->waiting_lock;
-	int dept = 0;
-	/* nested donation */
-	while (lock != NULL && lock->holder != NULL && dept < 8)
+/* thread->held_locks 힙 비교함수 : 기부받는 우선순위가 낮은 락이 less */
+static bool
+held_lock_less(const struct pairheap_elem *a, const struct pairheap_elem *b,
+			   void *aux UNUSED)
+{
+	return lock_donation(pairheap_entry(a, struct lock, held_elem)) <
+		   lock_donation(pairheap_entry(b, struct lock, held_elem));
+}
+
+/* T의 base_priority, 가진 락들의 기부, reader로서 받은 기부 중 최댓값 */
+static int
+thread_donated_priority(struct thread *t)
+{
+	struct pairheap_elem *top = pairheap_top(&t->held_locks);
+	int priority = t->base_priority;
+
+	for (struct list_elem *e = list_begin(&t->read_holds); e != list_end(&t->read_holds);
+		 e = list_next(e))
+	{
+		struct rwlock_hold *hold = list_entry(e, struct rwlock_hold, thread_elem);
+		if (hold->boost > priority)
+			priority = hold->boost;
+	}
+
+	if (top != NULL)
 	{
-		struct thread *holder = lock->holder;
+		int donation = lock_donation(pairheap_entry(top, struct lock, held_elem));
+		if (donation > priority)
+			priority = donation;
+	}
+	return priority;
+}
 
-		holder->priority = cur->priority;
+/* LOCK의 최고 대기자가 바뀌었을 때 소유자 쪽으로 전파한다.
+	소유자의 held_locks에서 LOCK 위치를 고치고 실효 우선순위를 다시 구한다.
+	fast path로 얻은 락은 아직 held_locks에 없으므로 여기서 넣는다.
+	소유자도 다른 락을 기다리고 있으면 그 락의 donors에서 위치를 고치고
+	다음 단계로 넘어간다. 우선순위가 그대로면 더 전파할 필요가 없으므로
+	깊이 제한 없이 변화가 있는 만큼만 올라간다. */
+static void
+donation_propagate(struct lock *lock)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
 
-		/* 중복 기부 방지를 위해 전체 순회 , donation_list 검사 -> nest 방지
-			donation_elem 은 기부자들 리스트이므로 중복된 사람이 들어올 필요X
-		*/
-		bool already = false;
-		struct list_elem *e;
-		for (e = list_begin(&holder->donation_list); e != list_end(&holder->donation_list); e = list_next(e))
+	while (lock != NULL && lock_owner(lock) != NULL)
+	{
+		struct thread *holder = lock_owner(lock);
+		int priority;
+
+		if (lock->tracked)
+			pairheap_update(&holder->held_locks, &lock->held_elem);
+		else
 		{
-			struct thread *donor = list_entry(e, struct thread, donation_elem);
-			if (donor == cur)
-			{
-				already = true;
-				break;
-			}
+			pairheap_push(&holder->held_locks, &lock->held_elem);
+			lock->tracked = true;
 		}
-		if (!already)
+		priority = thread_donated_priority(holder);
+		if (priority == holder->priority)
+			break;
+		thread_set_effective_priority(holder, priority);
+		schedtrace(SCHEDTRACE_DONATE, holder, priority);
+
+		lock = holder->waiting_lock;
+		if (lock != NULL)
+			pairheap_update(&lock->donors, &holder->donation_elem);
+		else if (holder->draining_rwlock != NULL)
+			readers_boost(holder->draining_rwlock, priority);
+	}
+}
+
+/* RW를 읽고 있는 스레드들의 우선순위를 적어도 PRIORITY로 올린다.
+	올라간 reader가 락을 기다리는 중이면 그 소유자 쪽으로도 전파한다.
+	받은 기부는 reader가 RW의 읽기를 마칠 때 사라진다. */
+static void
+readers_boost(struct rwlock *rw, int priority)
+{
+	struct list_elem *e;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	for (e = list_begin(&rw->reader_list); e != list_end(&rw->reader_list);
+		 e = list_next(e))
+	{
+		struct rwlock_hold *hold = list_entry(e, struct rwlock_hold, elem);
+		struct thread *reader = hold->thread;
+
+		if (priority <= hold->boost)
+			continue;
+		hold->boost = priority;
+		if (thread_donated_priority(reader) == reader->priority)
+			continue;
+		thread_set_effective_priority(reader, thread_donated_priority(reader));
+		schedtrace(SCHEDTRACE_DONATE, reader, reader->priority);
+		if (reader->waiting_lock != NULL)
 		{
-			list_push_back(&holder->donation_list, &cur->donation_elem);
+			pairheap_update(&reader->waiting_lock->donors, &reader->donation_elem);
+			donation_propagate(reader->waiting_lock);
 		}
-		/* 다음 단계로 */
-		cur = holder;
-		lock = cur->waiting_lock;
-		dept++;
 	}
+}
+
+/* 현재 스레드(writer)가 RW의 reader들이 빠지기를 기다린다.
+	기다리는 동안 reader들에게 우선순위를 기부하고,
+	나중에 내 우선순위가 오르면 donation_propagate()가 이어서 전파한다.
+	interrupt가 꺼진 채로 호출되어야 한다. */
+void thread_donate_to_readers(struct rwlock *rw)
+{
+	struct thread *cur = thread_current();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	cur->draining_rwlock = rw;
+	readers_boost(rw, cur->priority);
+}
+
+/* 현재 스레드가 LOCK을 기다린다. 처음이면 그 락의 donors에 들어가고,
+	소유자 쪽으로 우선순위를 전파한다. 깨어났다가 다른 스레드에게
+	락을 뺏겨 다시 기다릴 때는 새 소유자에게 전파만 한다. */
+void thread_donate_priority(struct lock *lock)
+{
+	enum intr_level old_level = intr_disable();
+	struct thread *cur = thread_current();
+
+	if (cur->waiting_lock != lock)
+	{
+		ASSERT(cur->waiting_lock == NULL);
+		cur->waiting_lock = lock;
+		pairheap_push(&lock->donors, &cur->donation_elem);
+	}
+	donation_propagate(lock);
 	intr_set_level(old_level);
 }
 
-/* lock_release()에서 lock과 관련된 기부자들을 제거하는 함수*/
-void thread_remove_donations_for_lock(struct lock *lock)
+/* lock_acquire()의 slow path에서 LOCK을 얻은 직후 호출.
+	현재 스레드를 소유자로 기록하고, 기다리던 중이었다면 donors에서 빠진다.
+	아직 기다리는 스레드가 있으면 LOCK을 held_locks에 넣어 그 기부를 받는다.
+	대기자가 없으면 넣지 않아 lock_release()가 fast path를 탈 수 있다. */
+void thread_take_donations_for_lock(struct lock *lock)
 {
+	enum intr_level old_level = intr_disable();
 	struct thread *cur = thread_current();
-	struct list_elem *e = list_begin(&cur->donation_list);
 
-	while (e != list_end(&cur->donation_list))
+	ASSERT(!lock->tracked);
+
+	lock->holder = cur;
+	if (cur->waiting_lock == lock)
+	{
+		pairheap_remove(&lock->donors, &cur->donation_elem);
+		cur->waiting_lock = NULL;
+	}
+	if (!pairheap_empty(&lock->donors))
 	{
-		struct thread *donor = list_entry(e, struct thread, donation_elem);
-		e = list_next(e);
-		if (donor->waiting_lock == lock)
-			list_remove(&donor->donation_elem);
+		pairheap_push(&cur->held_locks, &lock->held_elem);
+		lock->tracked = true;
+		thread_set_effective_priority(cur, thread_donated_priority(cur));
 	}
+	intr_set_level(old_level);
 }
 
-/* 기부 제거 후 base_priority / donateion_list의 최댓값 비교해
+/* lock_release()에서 LOCK을 통해 받던 기부를 제거하는 함수.
+	LOCK의 donors는 다음 소유자가 이어받는다. */
+void thread_remove_donations_for_lock(struct lock *lock)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (lock->tracked)
+	{
+		pairheap_remove(&thread_current()->held_locks, &lock->held_elem);
+		lock->tracked = false;
+	}
+	intr_set_level(old_level);
+}
+
+/* 기부 제거 후 base_priority / 가진 락들의 기부 중 최댓값으로
 							우선순위 업데이트해주는 함수*/
 void thread_update_priority(void)
 {
 	struct thread *cur = thread_current();
-	struct list_elem *e = list_begin(&cur->donation_list);
-	int max_prio = cur->base_priority;
 
-	while (e != list_end(&cur->donation_list))
+	/* ready 상태라면 선형 재탐색 없이 새 우선순위 큐로 옮겨진다 */
+	thread_set_effective_priority(cur, thread_donated_priority(cur));
+}
+
+/* EDF를 위한 함수들 */
+
+/* edf_queue 힙 비교함수 : 마감이 늦은 쪽이 less */
+static bool
+edf_deadline_later(const struct pairheap_elem *a, const struct pairheap_elem *b,
+				   void *aux UNUSED)
+{
+	return pairheap_entry(a, struct edf_entity, elem)->abs_deadline >
+		   pairheap_entry(b, struct edf_entity, elem)->abs_deadline;
+}
+
+/* 예약의 밀도 runtime / min(deadline, period)를 백만분율로.
+   밀도 합이 1 이하이면 단일 CPU에서 EDF로 모든 마감을 지킬 수 있다. */
+static int64_t
+edf_density_of(int64_t runtime, int64_t period, int64_t deadline)
+{
+	int64_t window = deadline < period ? deadline : period;
+
+	return runtime * 1000000 / window;
+}
+
+/* 현재 EDF 스레드가 이번 작업을 마치고 다음 릴리스까지 잠든다.
+   다음 작업은 새 예산과 새 마감 시각으로 시작한다.
+   마친 작업이 마감을 지켰으면 true. */
+bool thread_edf_wait(void)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level;
+	int64_t now;
+	bool met;
+
+	ASSERT(cur->edf);
+
+	old_level = intr_disable();
+	now = timer_ticks();
+	met = now <= cur->edf->abs_deadline;
+	cur->edf->jobs++;
+	edf_job_cnt++;
+	if (!met)
 	{
-		struct thread *donor = list_entry(e, struct thread, donation_elem);
-		e = list_next(e);
-		if (max_prio < donor->priority)
-		{
-			max_prio = donor->priority;
-		}
+		cur->edf->misses++;
+		edf_miss_cnt++;
 	}
-	cur->priority = max_prio;
-
-	/* ready_list에서 삽입 후 우선순위 변경이 이루어 졌을 때 다시 정렬
-		우선순위 기부받은 스레드가 가장 큰 스레드이므로 삭제후 맨 앞 삽입
-	*/
-	if (cur->status == THREAD_READY)
+	if (cur->edf->throttled)
 	{
-		list_remove(&cur->elem);
-		list_push_front(&ready_list, &cur->elem);
+		timer_cancel(&cur->edf->timer);
+		cur->edf->throttled = false;
 	}
+
+	/* 다음 릴리스. 이미 지나간 주기는 건너뛴다 */
+	cur->edf->release += cur->edf->period;
+	if (cur->edf->release < now)
+		cur->edf->release = now;
+	cur->edf->abs_deadline = cur->edf->release + cur->edf->deadline;
+	cur->edf->budget = cur->edf->runtime;
+	intr_set_level(old_level);
+
+	if (cur->edf->release > now)
+		timer_sleep(cur->edf->release - now);
+	return met;
+}
+
+/* 예산을 다 쓴 EDF 스레드 T_의 다음 릴리스. 타이머 인터럽트에서 불린다.
+   작업이 아직 끝나지 않았으므로 이어서 새 주기의 예산과 마감으로 실행한다.
+   큐 밖에서 기다리고 있었다면 edf_queue로 돌려보낸다. */
+static void
+edf_replenish(void *t_)
+{
+	struct thread *t = t_;
+	bool parked = t->status == THREAD_READY && t->edf->parked;
+
+	if (parked)
+		ready_queue_remove(t);
+	t->edf->throttled = false;
+	t->edf->release = t->edf->timer.expires;
+	t->edf->abs_deadline = t->edf->release + t->edf->deadline;
+	t->edf->budget = t->edf->runtime;
+	if (parked)
+		ready_queue_push(t);
+}
+
+/* CPU 사용량 계정을 위한 함수들
+
+	스레드는 acct_stamp 이후 흐른 시간을 지금 있는 쪽(유저/커널)에 더한다.
+	시각은 유저 모드에서 커널로 들어올 때(시스템 콜, 인터럽트, 예외),
+	유저 모드로 나갈 때, 문맥 교환 때 rdtsc로 찍는다.
+	ready 큐에서 기다린 시간은 ready_stamp부터 다시 실행될 때까지다. */
+
+/* T의 acct_stamp부터 NOW까지를 T의 usage에 더한다 */
+static void
+account(struct thread *t, uint64_t now)
+{
+	uint64_t delta = now - t->acct_stamp;
+
+	if (t->acct_user)
+		t->usage.utime += delta;
+	else
+		t->usage.stime += delta;
+	t->acct_stamp = now;
+}
+
+/* 현재 스레드가 유저 모드에서 커널로 들어왔다 */
+void thread_account_enter(void)
+{
+	struct thread *cur = thread_current();
+
+	account(cur, rdtsc());
+	cur->acct_user = false;
+}
+
+/* 현재 스레드가 커널에서 유저 모드로 나간다 */
+void thread_account_leave(void)
+{
+	struct thread *cur = thread_current();
+
+	account(cur, rdtsc());
+	cur->acct_user = true;
+}
+
+/* 현재 스레드의 지금까지의 사용량을 USAGE에 쓴다 */
+void thread_get_usage(struct rusage *usage)
+{
+	struct thread *cur = thread_current();
+	enum intr_level old_level = intr_disable();
+
+	account(cur, rdtsc());
+	*usage = cur->usage;
+	intr_set_level(old_level);
 }
 
 /* mlfqs를 위한 함수들*/
 /* 특정 스레드의 prirority 계산 함수*/
 void mlfqs_calculate_priority(struct thread *t)
 {
-	if (t == idle_thread)
+	if (is_idle_thread(t) || t->edf)
 		return;
-	t->priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+	int priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+
+	/* 큐 인덱스로 쓰이므로 PRI_MIN..PRI_MAX 범위로 제한 */
+	if (priority > PRI_MAX)
+		priority = PRI_MAX;
+	else if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	thread_set_effective_priority(t, priority);
 }
 
 /* 스레드의 recent_cpu 값을 계산하는 함수 */
 void mlfqs_calculate_recent_cpu(struct thread *t)
 {
-	if (t == idle_thread)
+	if (is_idle_thread(t))
 		return;
 	t->recent_cpu = add_mixed(mult_fp(div_fp(mult_mixed(load_avg, 2), add_mixed(mult_mixed(load_avg, 2), 1)), t->recent_cpu), t->nice);
 }
@@ -863,10 +1816,9 @@ void mlfqs_calculate_load_avg(void)
 {
 	int ready_threads;
 
-	if (thread_current() == idle_thread)
-		ready_threads = list_size(&ready_list);
-	else
-		ready_threads = list_size(&ready_list) + 1;
+	ready_threads = ready_cnt;
+	if (!is_idle_thread(thread_current()))
+		ready_threads++;
 
 	load_avg = add_fp(mult_fp(div_fp(int_to_fp(59), int_to_fp(60)), load_avg),
 					  mult_mixed(div_fp(int_to_fp(1), int_to_fp(60)), ready_threads));
@@ -875,32 +1827,179 @@ void mlfqs_calculate_load_avg(void)
 /* 현재 스레드의 recent_cpu의 값을 1 증가 */
 void mlfqs_increment_recent_cpu(void)
 {
-	if (thread_current() != idle_thread)
-		thread_current()->recent_cpu = add_mixed(thread_current()->recent_cpu, 1);
+	struct thread *cur = thread_current();
+
+	if (!is_idle_thread(cur))
+	{
+		/* 워커가 아직 감쇠를 적용하지 않았으면 먼저 적용 */
+		mlfqs_refresh(cur);
+		cur->recent_cpu = add_mixed(cur->recent_cpu, 1);
+		mlfqs_mark_dirty(cur);
+	}
 }
 
-/*모든 스레드의 recent_cpu 재계산*/
-void mlfqs_recalculate_recent_cpu(void)
+/* T를 다음 4틱 priority 재계산 대상에 올린다 */
+static void
+mlfqs_mark_dirty(struct thread *t)
 {
-	struct list_elem *e;
+	enum intr_level old_level = intr_disable();
+	if (!t->mlfqs_dirty)
+	{
+		t->mlfqs_dirty = true;
+		list_push_back(&dirty_list, &t->dirty_elem);
+	}
+	intr_set_level(old_level);
+}
 
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+/* 1초마다의 recent_cpu 감쇠 시작. 타이머 인터럽트에서 불린다.
+	이번 초의 감쇠 계수만 기록하고, 스레드들에 적용하는 일은
+	mlfqs_recalculate_recent_cpu()가 워커 스레드에서 한다.
+	그 전에 들여다보는 스레드는 mlfqs_refresh()로 먼저 따라잡는다. */
+void mlfqs_next_epoch(void)
+{
+	mlfqs_epoch++;
+	mlfqs_decay[mlfqs_epoch % MLFQS_EPOCHS] =
+		div_fp(mult_mixed(load_avg, 2), add_mixed(mult_mixed(load_avg, 2), 1));
+}
+
+/* 지금까지 시작된 감쇠의 epoch */
+int mlfqs_current_epoch(void)
+{
+	return mlfqs_epoch;
+}
+
+/* 1초마다의 recent_cpu 감쇠 적용의 한 배치. 인터럽트가 꺼진 채 불려야
+	하며, 스레드를 MLFQS_DECAY_BATCH개까지만 처리하고 다 끝났으면 true.
+	호출자는 배치 사이에 인터럽트를 켰다가 false인 동안 다시 부른다.
+	실행 중이거나 ready 상태인 스레드만 즉시 감쇠시키고 priority를
+	다시 계산한다. BLOCKED 스레드는 mlfqs_refresh()에서 밀린 만큼
+	적용되며, 링 버퍼 범위를 벗어나기 전에 여기서 따라잡는다. */
+bool mlfqs_recalculate_recent_cpu(void)
+{
+	uint64_t start = rdtsc();
+	int budget = MLFQS_DECAY_BATCH;
+	bool done = false;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (!decay_active)
 	{
-		struct thread *t = list_entry(e, struct thread, allelem);
-		mlfqs_calculate_recent_cpu(t);
+		struct thread *cur = thread_current();
+
+		if (!is_idle_thread(cur))
+			mlfqs_refresh(cur);
+		decay_active = true;
+		decay_pri = PRI_MIN;
+		decay_next = list_begin(&ready_queues[PRI_MIN]);
 	}
+
+	/* ready 큐들을 낮은 우선순위부터 이어서 훑는다 */
+	while (decay_pri <= PRI_MAX)
+	{
+		if (decay_next == list_end(&ready_queues[decay_pri]))
+		{
+			if (++decay_pri <= PRI_MAX)
+				decay_next = list_begin(&ready_queues[decay_pri]);
+			continue;
+		}
+		if (budget-- == 0)
+			goto out;
+		mlfqs_refresh(list_entry(decay_next, struct thread, elem));
+		decay_next = list_next(decay_next);
+	}
+	decay_next = NULL;
+
+	/* 곧 링 버퍼에서 밀려날 계수를 쓰는 스레드들.
+	   워커가 늦게 돌아도 넘치지 않도록 절반쯤 밀리면 따라잡는다 */
+	while (!list_empty(&lazy_list))
+	{
+		struct thread *t = list_entry(list_front(&lazy_list), struct thread, lazy_elem);
+		if (mlfqs_epoch - t->mlfqs_epoch < MLFQS_EPOCHS / 2)
+			break;
+		if (budget-- == 0)
+			goto out;
+		mlfqs_refresh(t);
+	}
+
+	/* 감쇠된 스레드들의 priority를 다음 4틱을 기다리지 않고 계산 */
+	while (!list_empty(&dirty_list))
+	{
+		if (budget-- == 0)
+			goto out;
+		mlfqs_recalculate_dirty(list_entry(list_front(&dirty_list),
+										   struct thread, dirty_elem));
+	}
+	decay_active = false;
+	decay_pass_cnt++;
+	done = true;
+
+out:
+	start = rdtsc() - start;
+	decay_batch_cnt++;
+	if (start > decay_batch_max)
+		decay_batch_max = start;
+	return done;
 }
 
-/* 모든 스레드의 priority를 재계산*/
-void mlfqs_recalculate_priority(void)
+/* T에 밀린 recent_cpu 감쇠를 한 초씩 순서대로 적용한다.
+	매 초 즉시 계산했을 때와 비트 단위로 같은 값이 나온다.
+	(BLOCKED 동안에는 nice가 바뀌지 않으므로)
+	MLFQS_EPOCHS초 이상 밀렸으면 그 극한값으로 근사한다.
+	감쇠가 적용되었으면 다음 4틱 재계산 대상에 올린다. */
+void mlfqs_refresh(struct thread *t)
 {
-	struct list_elem *e;
+	if (is_idle_thread(t) || t->mlfqs_epoch == mlfqs_epoch)
+		return;
 
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	/* 워커가 링 버퍼보다 오래 밀렸으면 필요한 계수가 이미 덮여 있다.
+	   그만큼 감쇠했으면 예전 recent_cpu는 거의 남지 않으므로
+	   recent_cpu = decay * recent_cpu + nice의 고정점
+	   nice * (2 * load_avg + 1)로 바로 맞춘다. */
+	if (mlfqs_epoch - t->mlfqs_epoch >= MLFQS_EPOCHS)
 	{
-		struct thread *t = list_entry(e, struct thread, allelem);
-		mlfqs_calculate_priority(t);
+		t->recent_cpu = mult_mixed(add_mixed(mult_mixed(load_avg, 2), 1), t->nice);
+		t->mlfqs_epoch = mlfqs_epoch;
 	}
+	while (t->mlfqs_epoch != mlfqs_epoch)
+	{
+		t->mlfqs_epoch++;
+		t->recent_cpu = add_mixed(mult_fp(mlfqs_decay[t->mlfqs_epoch % MLFQS_EPOCHS],
+										  t->recent_cpu),
+								  t->nice);
+	}
+
+	/* lazy_list의 epoch 순서를 지키기 위해 맨 뒤로 옮긴다 */
+	if (t->mlfqs_lazy)
+	{
+		list_remove(&t->lazy_elem);
+		list_push_back(&lazy_list, &t->lazy_elem);
+	}
+
+	/* 감쇠는 4틱 경계에서만 일어나므로 BLOCKED 스레드는 바로 계산해도
+	   4틱마다 재계산한 값과 같다. 실행 중/ready 스레드는 이번 틱의
+	   dirty 처리에서 같이 계산된다. */
+	if (t->status == THREAD_BLOCKED)
+		mlfqs_calculate_priority(t);
+	else
+		mlfqs_mark_dirty(t);
+}
+
+/* 4틱마다 recent_cpu가 바뀐 스레드의 priority만 재계산 */
+void mlfqs_recalculate_priority(void)
+{
+	while (!list_empty(&dirty_list))
+		mlfqs_recalculate_dirty(list_entry(list_front(&dirty_list),
+										   struct thread, dirty_elem));
+}
+
+/* dirty_list에 있는 T를 빼고 priority를 다시 계산한다 */
+static void
+mlfqs_recalculate_dirty(struct thread *t)
+{
+	list_remove(&t->dirty_elem);
+	t->mlfqs_dirty = false;
+	mlfqs_refresh(t);
+	mlfqs_calculate_priority(t);
 }
 
 /* fixed_point를 위한 함수 선언 및 정의 */
@@ -949,18 +2048,78 @@ int div_mixed(int x, int n)
 	return x / n;
 }
 
-/* tid로 스레드를 검색해 반환 */
+/* tid로 스레드를 검색해 반환. 없으면 NULL */
 struct thread *
 thread_by_tid(tid_t tid)
 {
-	struct list_elem *e;
-	for (e = list_begin(&all_list);
-		 e != list_end(&all_list);
-		 e = list_next(e))
+	struct thread key;
+	struct hash_elem *e;
+
+	key.tid = tid;
+	lock_acquire(&thread_table_lock);
+	e = hash_find(&thread_table, &key.tid_elem);
+	lock_release(&thread_table_lock);
+	return e != NULL ? hash_entry(e, struct thread, tid_elem) : NULL;
+}
+
+/* CACHE에서 페이지 하나를 꺼낸다. 비어 있으면 NULL */
+static void *
+page_cache_get(struct page_cache *cache)
+{
+	enum intr_level old_level = intr_disable();
+	void *page = cache->cnt > 0 ? cache->pages[--cache->cnt] : NULL;
+	intr_set_level(old_level);
+	return page;
+}
+
+/* PAGE를 CACHE에 넣는다. 가득 찼으면 false를 돌려주고
+   호출자가 palloc_free_page()로 해제해야 한다 */
+static bool
+page_cache_put(struct page_cache *cache, void *page)
+{
+	enum intr_level old_level = intr_disable();
+	bool cached = cache->cnt < PAGE_CACHE_MAX;
+	if (cached)
+		cache->pages[cache->cnt++] = page;
+	intr_set_level(old_level);
+	return cached;
+}
+
+/* 캐시해 둔 스레드 페이지를 모두 palloc에 돌려준다.
+   커널 풀이 부족할 때 palloc_get_multiple()에서 호출한다.
+   돌려준 페이지 수를 반환 */
+size_t thread_cache_reclaim(void)
+{
+	size_t freed = 0;
+	void *page;
+
+	while ((page = page_cache_get(&thread_page_cache)) != NULL)
 	{
-		struct thread *t = list_entry(e, struct thread, allelem);
-		if (t->tid == tid)
-			return t;
+		palloc_free_page(page);
+		freed++;
 	}
-	return NULL;
-}
\ No newline at end of file
+	return freed;
+}
+
+/* T를 thread_table에 등록 */
+static void
+thread_table_insert(struct thread *t)
+{
+	lock_acquire(&thread_table_lock);
+	hash_insert(&thread_table, &t->tid_elem);
+	lock_release(&thread_table_lock);
+}
+
+/* thread_table의 해시 함수 */
+static uint64_t
+thread_tid_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	return hash_int(hash_entry(e, struct thread, tid_elem)->tid);
+}
+
+/* thread_table의 비교 함수 */
+static bool
+thread_tid_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+{
+	return hash_entry(a, struct thread, tid_elem)->tid < hash_entry(b, struct thread, tid_elem)->tid;
+}
@@ -0,0 +1,204 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* 워크큐.
+   인터럽트 핸들러와 다른 서브시스템이 무거운 일을 미뤄 두는 곳.
+   큐마다 전용 워커 스레드가 있어 항목을 들어온 순서대로 인터럽트를 켠
+   채 실행한다. 넣는 쪽은 호출자가 가진 struct work를 리스트에 잇고
+   세마포어를 올리는 것뿐이라 할당이 없고 인터럽트 안에서도 부를 수 있다.
+   work_queue_delayed()는 타이밍 휠에 항목의 타이머를 걸어 두었다가
+   만료되면 큐에 넣는다.
+   모든 큐의 items와 항목의 pending/queued는 인터럽트를 꺼서 보호한다. */
+
+struct workqueue wq_high;
+struct workqueue wq_default;
+struct workqueue wq_low;
+
+static thread_func worker;
+static timer_func delayed_expire;
+
+/* 시스템 워크큐와 워커 스레드를 만든다.
+   thread_start()에서 인터럽트를 켜기 전에 불린다. */
+void
+workqueue_init (void) {
+	if (!workqueue_create (&wq_high, "wq_high", PRI_MAX)
+			|| !workqueue_create (&wq_default, "wq_default", PRI_DEFAULT)
+			|| !workqueue_create (&wq_low, "wq_low", PRI_MIN))
+		PANIC ("workqueue_init: cannot create worker threads");
+}
+
+/* WQ를 빈 큐로 초기화하고 우선순위 PRIORITY의 워커 스레드 NAME을
+   만든다. 스레드를 만들지 못하면 false. WQ는 없앨 수 없다. */
+bool
+workqueue_create (struct workqueue *wq, const char *name, int priority) {
+	ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+	wq->name = name;
+	wq->priority = priority;
+	list_init (&wq->items);
+	sema_init (&wq->avail, 0);
+	wq->done_cnt = 0;
+	return thread_create (name, priority, worker, wq) != TID_ERROR;
+}
+
+/* W를 FUNC(AUX)를 실행하는 항목으로 초기화한다. */
+void
+work_init (struct work *w, work_func *func, void *aux) {
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->aux = aux;
+	w->pending = false;
+	w->queued = false;
+	w->wq = NULL;
+	timer_event_init (&w->timer, delayed_expire, w);
+}
+
+/* W를 WQ에 넣는다. 인터럽트 핸들러에서도 부를 수 있다.
+   W가 이미 pending이면 아무것도 하지 않고 false. */
+bool
+work_queue (struct workqueue *wq, struct work *w) {
+	enum intr_level old_level = intr_disable ();
+
+	if (w->pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	w->pending = true;
+	w->wq = wq;
+	list_push_back (&wq->items, &w->elem);
+	w->queued = true;
+	intr_set_level (old_level);
+	sema_up (&wq->avail);
+	return true;
+}
+
+/* TICKS 틱 뒤에 W를 WQ에 넣는다. TICKS가 0 이하면 바로 넣는다.
+   인터럽트 핸들러에서도 부를 수 있다.
+   W가 이미 pending이면 아무것도 하지 않고 false. */
+bool
+work_queue_delayed (struct workqueue *wq, struct work *w, int64_t ticks) {
+	enum intr_level old_level;
+
+	if (ticks <= 0)
+		return work_queue (wq, w);
+
+	old_level = intr_disable ();
+	if (w->pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	w->pending = true;
+	w->wq = wq;
+	timer_add (&w->timer, timer_ticks () + ticks);
+	intr_set_level (old_level);
+	return true;
+}
+
+/* 지연 항목 W_의 타이머 만료. 타이머 인터럽트에서 불린다.
+   그 사이에 취소되었으면 넣지 않는다. */
+static void
+delayed_expire (void *w_) {
+	struct work *w = w_;
+	enum intr_level old_level = intr_disable ();
+	bool pending = w->pending;
+
+	if (pending) {
+		list_push_back (&w->wq->items, &w->elem);
+		w->queued = true;
+	}
+	intr_set_level (old_level);
+	if (pending)
+		sema_up (&w->wq->avail);
+}
+
+/* 아직 실행되지 않은 W를 취소한다. 취소했으면 true.
+   이미 실행 중이거나 끝났으면 false이며, 실행이 끝나기를 기다리지는
+   않는다. */
+bool
+work_cancel (struct work *w) {
+	enum intr_level old_level = intr_disable ();
+	bool cancelled = false;
+
+	if (w->queued) {
+		list_remove (&w->elem);
+		w->queued = false;
+		cancelled = true;
+	} else if (w->pending)
+		cancelled = timer_cancel (&w->timer);
+	if (cancelled)
+		w->pending = false;
+	intr_set_level (old_level);
+
+	/* 취소한 항목의 avail up은 워커가 빈 큐를 보고 흘려보낸다. */
+	return cancelled;
+}
+
+/* workqueue_flush()가 넣는 표지. */
+struct barrier {
+	struct work work;
+	struct semaphore done;
+};
+
+static void
+barrier_done (void *b_) {
+	struct barrier *b = b_;
+
+	sema_up (&b->done);
+}
+
+/* 지금까지 WQ에 들어간 항목이 모두 실행될 때까지 기다린다.
+   아직 타이머를 기다리는 지연 항목은 기다리지 않는다. */
+void
+workqueue_flush (struct workqueue *wq) {
+	struct barrier b;
+
+	ASSERT (!intr_context ());
+
+	work_init (&b.work, barrier_done, &b);
+	sema_init (&b.done, 0);
+	work_queue (wq, &b.work);
+	sema_down (&b.done);
+}
+
+/* 워커 스레드. WQ_의 항목을 하나씩 꺼내 실행한다.
+   항목은 실행 중에 해제될 수 있으므로 실행한 뒤에는 건드리지 않는다. */
+static void
+worker (void *wq_) {
+	struct workqueue *wq = wq_;
+
+	/* mlfqs와 CFS는 우선순위 대신 nice로 몫을 정하므로
+	   큐의 우선순위를 nice로 옮긴다. PRI_MAX는 NICE_MIN이 된다. */
+	if (thread_mlfqs || thread_cfs)
+		thread_set_nice ((PRI_DEFAULT - wq->priority) * NICE_MIN
+				/ (PRI_DEFAULT - PRI_MAX));
+
+	for (;;) {
+		struct work *w = NULL;
+		enum intr_level old_level;
+
+		sema_down (&wq->avail);
+		old_level = intr_disable ();
+		if (!list_empty (&wq->items)) {
+			w = list_entry (list_pop_front (&wq->items), struct work, elem);
+			w->queued = false;
+			w->pending = false;
+		}
+		intr_set_level (old_level);
+
+		if (w != NULL) {
+			w->func (w->aux);
+			wq->done_cnt++;
+		}
+	}
+}
+
+/* 시스템 워크큐가 실행한 항목 수를 출력한다. */
+void
+workqueue_print_stats (void) {
+	printf ("Workqueue: %lld high, %lld default, %lld low items run\n",
+			wq_high.done_cnt, wq_default.done_cnt, wq_low.done_cnt);
+}
@@ -4,6 +4,7 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "intrinsic.h"
 #include "userprog/syscall.h"
 
@@ -142,6 +143,21 @@ page_fault(struct intr_frame *f)
 	not_present = (f->error_code & PF_P) == 0;
 	write = (f->error_code & PF_W) != 0;
 	user = (f->error_code & PF_U) != 0;
+
+	/* getrusage()가 보고할 스레드별 페이지 폴트 수 */
+	thread_current()->usage.faults++;
+
+#ifdef VM
+	/* For project 3 and later. */
+	if (vm_try_handle_fault(f, fault_addr, user, write, not_present))
+		return;
+
+	/* 처리하지 못한 유저 주소 폴트는 시스템 콜 안에서 났더라도
+	   커널이 아닌 프로세스의 잘못이다 */
+	if (!user && is_user_vaddr(fault_addr) && thread_current()->pml4 != NULL)
+		sys_exit(-1);
+#endif
+
 	/* 유저 모드에서의 페이지 폴트라면, 즉시 종료 */
 	if (user)
 	{
@@ -150,12 +166,6 @@ page_fault(struct intr_frame *f)
 		NOT_REACHED();
 	}
 
-#ifdef VM
-	/* For project 3 and later. */
-	if (vm_try_handle_fault(f, fault_addr, user, write, not_present))
-		return;
-#endif
-
 	/* Count page faults. */
 	page_fault_cnt++;
 
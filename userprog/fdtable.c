@@ -0,0 +1,210 @@
+#include "userprog/fdtable.h"
+#include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+
+/* used 비트맵 한 워드의 비트 수. */
+#define WORD_BITS 64
+
+/* 슬롯 CAP개를 덮는 비트맵 워드 수. */
+static size_t
+used_words(int cap)
+{
+	return DIV_ROUND_UP(cap, WORD_BITS);
+}
+
+/* T를 열린 fd가 없는 빈 테이블로 초기화한다.
+   슬롯은 struct 안의 inline_files를 쓰므로 할당이 없다. */
+void fd_table_init(struct fd_table *t)
+{
+	memset(t->inline_files, 0, sizeof t->inline_files);
+	t->inline_used = 0;
+	t->files = t->inline_files;
+	t->used = &t->inline_used;
+	t->cap = FD_INLINE_CNT;
+	t->max = FD_MAX_DEFAULT;
+	t->cnt = 0;
+}
+
+/* T가 fd NEED까지 담을 수 있도록 슬롯 배열을 두 배씩 늘린다.
+   슬롯 배열과 비트맵은 한 블록으로 할당한다.
+   NEED는 T->max보다 작아야 하며, 크기가 넘치거나 메모리가 부족하면
+   false. */
+static bool
+grow(struct fd_table *t, int need)
+{
+	size_t cap = t->cap;
+	size_t old_words = used_words(t->cap);
+	size_t words;
+	struct file **files;
+	uint64_t *used;
+
+	ASSERT(need < t->max);
+	while (cap <= (size_t)need)
+	{
+		if (cap > SIZE_MAX / 2)
+			return false;
+		cap *= 2;
+	}
+	if (cap > (size_t)t->max)
+		cap = t->max;
+	words = used_words(cap);
+	if (cap > (SIZE_MAX - words * sizeof *used) / sizeof *files)
+		return false;
+
+	files = malloc(cap * sizeof *files + words * sizeof *used);
+	if (files == NULL)
+		return false;
+	used = (uint64_t *)(files + cap);
+
+	memcpy(files, t->files, t->cap * sizeof *files);
+	memset(files + t->cap, 0, (cap - t->cap) * sizeof *files);
+	memcpy(used, t->used, old_words * sizeof *used);
+	memset(used + old_words, 0, (words - old_words) * sizeof *used);
+
+	if (t->files != t->inline_files)
+		free(t->files);
+	t->files = files;
+	t->used = used;
+	t->cap = cap;
+	return true;
+}
+
+/* SRC의 열린 fd를 모두 DST에 같은 번호로 복제한다. (fork)
+   DST는 fd_table_init()으로 초기화된 빈 테이블이어야 한다.
+   콘솔은 공유하고 나머지 파일은 file_duplicate()로 복제한다.
+   열린 fd 수에 비례하는 비용만 든다. 실패하면 false. */
+bool fd_table_copy(struct fd_table *dst, struct fd_table *src)
+{
+	size_t w;
+
+	ASSERT(dst->cnt == 0);
+	dst->max = src->max;
+	if (src->cap > dst->cap && !grow(dst, src->cap - 1))
+		return false;
+
+	for (w = 0; w < used_words(src->cap); w++)
+	{
+		uint64_t bits = src->used[w];
+		while (bits != 0)
+		{
+			int fd = w * WORD_BITS + __builtin_ctzll(bits);
+			struct file *f = src->files[fd];
+			bits &= bits - 1;
+
+			if (f != &console_in && f != &console_out)
+				f = file_duplicate(f);
+			if (f == NULL)
+				return false;
+			dst->files[fd] = f;
+			dst->used[fd / WORD_BITS] |= 1ULL << (fd % WORD_BITS);
+			dst->cnt++;
+		}
+	}
+	return true;
+}
+
+/* T의 열린 파일을 모두 닫고 늘려 둔 슬롯 배열을 해제한다.
+   T는 다시 빈 테이블이 된다. */
+void fd_table_destroy(struct fd_table *t)
+{
+	int max = t->max;
+	size_t w;
+
+	for (w = 0; w < used_words(t->cap); w++)
+	{
+		uint64_t bits = t->used[w];
+		while (bits != 0)
+		{
+			int fd = w * WORD_BITS + __builtin_ctzll(bits);
+			bits &= bits - 1;
+			file_close(t->files[fd]);
+		}
+	}
+
+	if (t->files != t->inline_files)
+		free(t->files);
+	fd_table_init(t);
+	t->max = max;
+}
+
+/* T가 열 수 있는 fd의 상한을 MAX로 바꾼다.
+   MAX가 FD_MAX_LIMIT를 넘거나 MAX 이상의 fd가 이미 열려 있으면
+   바꾸지 않고 false. */
+bool fd_table_set_max(struct fd_table *t, int max)
+{
+	int fd;
+
+	if (max <= 0 || max > FD_MAX_LIMIT)
+		return false;
+	for (fd = max; fd < t->cap; fd++)
+		if (t->files[fd] != NULL)
+			return false;
+	t->max = max;
+	return true;
+}
+
+/* F를 T의 가장 작은 빈 fd에 넣고 그 번호를 반환한다.
+   상한에 닿았거나 메모리가 부족하면 -1. */
+int fd_alloc(struct fd_table *t, struct file *f)
+{
+	size_t words = used_words(t->cap);
+	size_t w;
+	int fd = words * WORD_BITS;
+
+	for (w = 0; w < words; w++)
+		if (~t->used[w] != 0)
+		{
+			fd = w * WORD_BITS + __builtin_ctzll(~t->used[w]);
+			break;
+		}
+
+	if (fd >= t->max)
+		return -1;
+	if (!fd_install(t, fd, f))
+		return -1;
+	return fd;
+}
+
+/* F를 T의 FD 자리에 넣는다. (dup2)
+   이미 열려 있던 파일은 호출자가 먼저 닫아야 한다.
+   FD가 상한을 벗어나거나 메모리가 부족하면 false. */
+bool fd_install(struct fd_table *t, int fd, struct file *f)
+{
+	ASSERT(f != NULL);
+
+	if (fd < 0 || fd >= t->max)
+		return false;
+	if (fd >= t->cap && !grow(t, fd))
+		return false;
+
+	if (t->files[fd] == NULL)
+	{
+		t->used[fd / WORD_BITS] |= 1ULL << (fd % WORD_BITS);
+		t->cnt++;
+	}
+	t->files[fd] = f;
+	return true;
+}
+
+/* T의 FD에 열린 파일을 반환한다. 없으면 NULL. */
+struct file *fd_get(struct fd_table *t, int fd)
+{
+	return fd >= 0 && fd < t->cap ? t->files[fd] : NULL;
+}
+
+/* T에서 FD를 비우고 들어 있던 파일을 반환한다. 닫지는 않는다. */
+struct file *fd_remove(struct fd_table *t, int fd)
+{
+	struct file *f = fd_get(t, fd);
+
+	if (f != NULL)
+	{
+		t->files[fd] = NULL;
+		t->used[fd / WORD_BITS] &= ~(1ULL << (fd % WORD_BITS));
+		t->cnt--;
+	}
+	return f;
+}
@@ -13,6 +13,7 @@
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
@@ -27,8 +28,36 @@
 
 static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
-static void initd(void *f_name);
+static void initd(void *aux);
 static void __do_fork(void *);
+static struct child_status *child_status_create(struct thread *parent);
+static void child_status_destroy(struct child_status *c);
+static uint64_t child_status_hash(const struct hash_elem *e, void *aux);
+static bool child_status_less(const struct hash_elem *a, const struct hash_elem *b, void *aux);
+static void rusage_add(struct rusage *dst, const struct rusage *src);
+
+/* process_fork()가 __do_fork()에 넘기는 인자.
+   자식이 실행되기 전에 부모와 child_status를 알 수 있게 함께 넘긴다. */
+struct fork_args
+{
+	struct intr_frame if_;		 /* 부모의 유저 컨텍스트 */
+	struct thread *parent;		 /* fork를 호출한 부모 */
+	struct child_status *status; /* 부모가 가진 자식의 기록 */
+};
+
+/* initd에 넘기는 인자. fork_args처럼 child_status를 자식이 실행되기
+   전에 넘겨 주어, 부모가 자식 스레드를 찾아 고칠 필요가 없게 한다. */
+struct initd_args
+{
+	char *file_name;			 /* 실행할 명령줄 (페이지) */
+	tid_t parent_tid;			 /* initd를 만든 부모 */
+	struct child_status *status; /* 부모가 가진 자식의 기록 */
+};
+
+/* 자식 tid를 키로 하는 child_status 해시 테이블.
+   process_wait()이 children 리스트를 순회하지 않도록 한다. */
+static struct hash status_table;
+static struct lock status_lock;
 
 /* General process initializer for initd and other process. */
 static void
@@ -36,14 +65,10 @@ process_init(void)
 {
 	struct thread *cur = thread_current();
 
-	cur->fd_table = palloc_get_page(PAL_ZERO);
-	if (cur->fd_table == NULL)
-		PANIC("process_init: cannot alloc fd_table");
-
-	/* console_in/out 은 이미 thread_init() 시점에 초기화해 두었다고 가정 */
-	cur->fd_table[0] = &console_in;
-	cur->fd_table[1] = &console_out;
-	cur->next_fd = 2;
+	/* console_in/out 은 이미 thread_init() 시점에 초기화해 두었다고 가정.
+	   빈 테이블에 넣으므로 inline 슬롯이라 실패하지 않는다. */
+	fd_install(&cur->fd_table, 0, &console_in);
+	fd_install(&cur->fd_table, 1, &console_out);
 }
 
 /* Starts the first userland program, called "initd", loaded from FILE_NAME.
@@ -71,45 +96,66 @@ tid_t process_create_initd(const char *file_name)
 		namelen = NAME_MAX;
 	strlcpy(prog_name, fn_copy, namelen + 1);
 
+	/* 한 번만 호출되므로 여기서 status_table을 만든다 */
+	lock_init(&status_lock);
+	if (!hash_init(&status_table, child_status_hash, child_status_less, NULL))
+	{
+		palloc_free_page(fn_copy);
+		return TID_ERROR;
+	}
+
 	/* 2) child_status 만들고 부모 리스트에 등록 */
-	struct child_status *c = malloc(sizeof *c);
+	struct initd_args *args = malloc(sizeof *args);
+	if (!args)
+	{
+		palloc_free_page(fn_copy);
+		return TID_ERROR;
+	}
+	struct child_status *c = child_status_create(parent);
 	if (!c)
 	{
+		free(args);
 		palloc_free_page(fn_copy);
 		return TID_ERROR;
 	}
-	sema_init(&c->sema, 0);
-	c->has_exited = false;
-	c->exit_status = -1;
-	list_push_back(&parent->children, &c->elem);
+	args->file_name = fn_copy;
+	args->parent_tid = parent->tid;
+	args->status = c;
 
 	/* 3) Create a new thread to execute FILE_NAME. */
-	tid = thread_create(prog_name, PRI_DEFAULT, initd, fn_copy);
+	tid = thread_create(prog_name, PRI_DEFAULT, initd, args);
 	if (tid == TID_ERROR)
 	{
-		list_remove(&c->elem);
-		free(c);
+		child_status_destroy(c);
+		free(args);
 		palloc_free_page(fn_copy);
 		return TID_ERROR;
 	}
 	/* 4) 성공하면 child_status에 TID 저장 */
 	c->tid = tid;
-	thread_by_tid(tid)->parent_tid = parent->tid;
 
 	/* 5) 부모는 initd 준비까지 기다렸다가 리턴 */
 	sema_down(&c->sema);
-	list_remove(&c->elem);
-	free(c);
+	child_status_destroy(c);
 
 	return tid;
 }
 
 /* A thread function that launches first user process. */
 static void
-initd(void *f_name)
+initd(void *aux)
 {
+	struct initd_args *args = aux;
+	struct thread *current = thread_current();
+	char *f_name = args->file_name;
+
+	/* 무엇보다 먼저 부모의 child_status와 연결해야 종료 상태가 전달된다 */
+	current->parent_tid = args->parent_tid;
+	current->child_status = args->status;
+	free(args);
+
 #ifdef VM
-	supplemental_page_table_init(&thread_current()->spt);
+	supplemental_page_table_init(&current->spt);
 #endif
 
 	process_init();
@@ -125,39 +171,37 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
 {
 	struct thread *parent = thread_current();
 	/* 1) 부모의 intr_frame 을 페이지 단위로 복사 */
-	struct intr_frame *child_if = palloc_get_page(PAL_ZERO);
-	if (!child_if)
+	struct fork_args *args = palloc_get_page(PAL_ZERO);
+	if (!args)
 		return TID_ERROR;
-	*child_if = *if_;
+	args->if_ = *if_;
 	/* 자식 프로세스가 fork 리턴 받을 땐 0이 되어야 함*/
-	child_if->R.rax = 0;
+	args->if_.R.rax = 0;
+	args->parent = parent;
 
 	/* 2) 부모의 children 리스트에 등록할 구조체 할당 */
-	struct child_status *c = malloc(sizeof *c);
+	struct child_status *c = child_status_create(parent);
 	if (!c)
 	{
-		palloc_free_page(child_if);
+		palloc_free_page(args);
 		return TID_ERROR;
 	}
-	sema_init(&c->sema, 0);
-	c->has_exited = false;
-	c->exit_status = -1;
-	list_push_back(&parent->children, &c->elem);
+	args->status = c;
 
 	/* 3) 실제 자식 스레드 생성 (__do_fork 가 실행될 것) */
-	tid_t child_tid = thread_create(name, PRI_DEFAULT, __do_fork, child_if);
+	tid_t child_tid = thread_create(name, PRI_DEFAULT, __do_fork, args);
 	if (child_tid == TID_ERROR)
 	{
-		list_remove(&c->elem);
-		free(c);
-		palloc_free_page(child_if);
+		child_status_destroy(c);
+		palloc_free_page(args);
 		return TID_ERROR;
 	}
 	/* 4) 자식 TID를 child_status 에 저장 후 부모에 리턴 */
 	c->tid = child_tid;
+	lock_acquire(&status_lock);
+	hash_insert(&status_table, &c->hash_elem);
+	lock_release(&status_lock);
 
-	struct thread *child = thread_by_tid(child_tid);
-	child->parent_tid = parent->tid;
 	sema_down(&c->sema);
 	return child_tid;
 	/* Clone current thread to new thread.*/
@@ -213,10 +257,15 @@ duplicate_pte(uint64_t *pte, void *va, void *aux)
 static void
 __do_fork(void *aux)
 {
-	struct intr_frame child_if = *(struct intr_frame *)aux;
-	palloc_free_page(aux);
+	struct fork_args *args = aux;
+	struct intr_frame child_if = args->if_;
 	struct thread *current = thread_current();
-	struct thread *parent = thread_by_tid(current->parent_tid);
+	struct thread *parent = args->parent;
+
+	/* 부모와 child_status를 먼저 연결해 두어야 실패해도 부모가 깨어난다 */
+	current->parent_tid = parent->tid;
+	current->child_status = args->status;
+	palloc_free_page(args);
 	/* TODO: somehow pass the parent_if. (i.e. process_fork()'s if_) */
 	bool succ = true;
 
@@ -241,38 +290,15 @@ __do_fork(void *aux)
 	 * TODO:       from the fork() until this function successfully duplicates
 	 * TODO:       the resources of parent.*/
 
-	for (int fd = 0; fd < MAX_FD; fd++)
-	{
-		struct file *f = parent->fd_table[fd];
-		if (f == NULL)
-		{
-			current->fd_table[fd] = NULL;
-		}
-		else if (f == &console_in || f == &console_out)
-		{
-			/* stdin : console_in 공유 */
-			current->fd_table[fd] = f;
-		}
-		else
-			current->fd_table[fd] = file_duplicate(f);
-	}
-	current->next_fd = parent->next_fd;
+	/* 열려 있는 fd만 같은 번호로 복제한다 */
+	if (!fd_table_copy(&current->fd_table, &parent->fd_table))
+		goto error;
 
-	if (parent != NULL)
+	/* 부모의 child_status는 fork 시점에 연결되어 있다 */
+	if (current->child_status != NULL)
 	{
-		struct list_elem *e;
-		for (e = list_begin(&parent->children);
-			 e != list_end(&parent->children);
-			 e = list_next(e))
-		{
-			struct child_status *c = list_entry(e, struct child_status, elem);
-			if (c->tid == current->tid)
-			{
-				c->has_exited = false; // 아직 exit 전
-				sema_up(&c->sema);
-				break;
-			}
-		}
+		current->child_status->has_exited = false; // 아직 exit 전
+		sema_up(&current->child_status->sema);
 	}
 	/* Finally, switch to the newly created process. */
 	if (succ)
@@ -298,6 +324,9 @@ int process_exec(void *f_name)
 
 	/* We first kill the current context */
 	process_cleanup();
+#ifdef VM
+	supplemental_page_table_init(&thread_current()->spt);
+#endif
 
 	/* And then load the binary */
 	success = load(file_name, &_if);
@@ -329,31 +358,33 @@ int process_wait(tid_t child_tid UNUSED)
 	 * XXX:       to add infinite loop here before
 	 * XXX:       implementing the process_wait. */
 	struct thread *cur = thread_current();
-	struct list_elem *e;
+	struct child_status key;
+	struct hash_elem *e;
 	struct child_status *c = NULL;
 
-	/* 1) 자식 리스트에서 기다릴 child_tid 찾기 */
-	for (e = list_begin(&cur->children); e != list_end(&cur->children); e = list_next(e))
-	{
-		struct child_status *tmp = list_entry(e, struct child_status, elem);
-		if (tmp->tid == child_tid)
-		{
-			c = tmp;
-			break;
-		}
-	}
+	/* 1) status_table에서 기다릴 child_tid 찾기 */
+	key.tid = child_tid;
+	lock_acquire(&status_lock);
+	e = hash_find(&status_table, &key.hash_elem);
+	lock_release(&status_lock);
+	if (e != NULL)
+		c = hash_entry(e, struct child_status, hash_elem);
+
 	/* 내 자식이 아니거나 이미 wait 한 경우 */
-	if (c == NULL)
+	if (c == NULL || c->parent_tid != cur->tid)
 		return -1;
 
 	/* 2) 아직 자식이 exit() 안 했으면 대기 */
 	if (!c->has_exited)
 		sema_down(&c->sema);
 
-	/* 3) 자식 exit_status 가져온 뒤 정리 */
+	/* 3) 자식 exit_status와 사용량을 가져온 뒤 정리 */
 	int status = c->exit_status;
-	list_remove(&c->elem);
-	free(c);
+	if (cur->child_usage == NULL)
+		cur->child_usage = calloc(1, sizeof *cur->child_usage);
+	if (cur->child_usage != NULL) // 메모리가 없으면 사용량만 잃는다
+		rusage_add(cur->child_usage, &c->usage);
+	child_status_destroy(c);
 	return status;
 }
 
@@ -365,8 +396,6 @@ void process_exit(void)
 	 * TODO: project2/process_termination.html).
 	 * TODO: We recommend you to implement process resource cleanup here. */
 	struct thread *curr = thread_current();
-	struct thread *parent;
-	struct list_elem *e;
 	struct child_status *c;
 
 	/* --- USERPROG 에서만 종료메시지 찍게 설정하기 --- */
@@ -375,43 +404,89 @@ void process_exit(void)
 		/* 1) 종료 메시지 출력 */
 		printf("%s: exit(%d)\n", curr->name, curr->exit_status);
 
+#ifdef VM
+		/* mmap한 파일을 되돌려 쓴 뒤에 깨워야 부모가 바뀐 내용을 읽는다 */
+		supplemental_page_table_kill(&curr->spt);
+#endif
+
 		/* 2) 부모에게 exit 상태 전달 및 sema_up() */
-		if (curr->parent_tid != TID_ERROR)
+		c = curr->child_status;
+		if (c != NULL)
 		{
-			parent = thread_by_tid(curr->parent_tid);
-			if (parent != NULL)
-			{
-				for (e = list_begin(&parent->children);
-					 e != list_end(&parent->children);
-					 e = list_next(e))
-				{
-					c = list_entry(e, struct child_status, elem);
-					if (c->tid == curr->tid)
-					{
-						c->exit_status = curr->exit_status;
-						c->has_exited = true;
-						sema_up(&c->sema);
-						break;
-					}
-				}
-			}
+			c->exit_status = curr->exit_status;
+			/* 부모가 거둘 사용량 : 나와 내가 거둔 자손들 */
+			thread_get_usage(&c->usage);
+			if (curr->child_usage != NULL)
+				rusage_add(&c->usage, curr->child_usage);
+			c->has_exited = true;
+			sema_up(&c->sema);
 		}
 
-		// TODO: fd_table 순회하여 file_close()
-		for (int fd = 0; fd < MAX_FD; fd++)
-		{
-			struct file *f = curr->fd_table[fd];
-			if (f != NULL && f != &console_in /* stdin 예외 */
-				&& f != &console_out)		  /* stdout 예외 */
-			{
-				file_close(curr->fd_table[fd]);
-				curr->fd_table[fd] = NULL;
-			}
-		}
+		/* 열려 있는 fd만 닫는다. 콘솔은 file_close()가 무시한다 */
+		fd_table_destroy(&curr->fd_table);
 	}
+	free(curr->child_usage);
+	curr->child_usage = NULL;
 	process_cleanup();
 }
 
+/* PARENT의 children 리스트에 새 child_status를 만들어 등록한다.
+ * tid는 자식 스레드가 만들어진 뒤에 채운다. 실패하면 NULL */
+static struct child_status *
+child_status_create(struct thread *parent)
+{
+	struct child_status *c = malloc(sizeof *c);
+	if (!c)
+		return NULL;
+	c->tid = TID_ERROR;
+	c->parent_tid = parent->tid;
+	sema_init(&c->sema, 0);
+	c->has_exited = false;
+	c->exit_status = -1;
+	list_push_back(&parent->children, &c->elem);
+	return c;
+}
+
+/* C를 부모의 children 리스트와 status_table에서 빼고 해제한다 */
+static void
+child_status_destroy(struct child_status *c)
+{
+	list_remove(&c->elem);
+	if (c->tid != TID_ERROR)
+	{
+		lock_acquire(&status_lock);
+		hash_delete(&status_table, &c->hash_elem);
+		lock_release(&status_lock);
+	}
+	free(c);
+}
+
+/* status_table의 해시 함수 */
+static uint64_t
+child_status_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	return hash_int(hash_entry(e, struct child_status, hash_elem)->tid);
+}
+
+/* status_table의 비교 함수 */
+static bool
+child_status_less(const struct hash_elem *a, const struct hash_elem *b, void *aux UNUSED)
+{
+	return hash_entry(a, struct child_status, hash_elem)->tid < hash_entry(b, struct child_status, hash_elem)->tid;
+}
+
+/* SRC의 사용량을 DST에 더한다 */
+static void
+rusage_add(struct rusage *dst, const struct rusage *src)
+{
+	dst->utime += src->utime;
+	dst->stime += src->stime;
+	dst->wtime += src->wtime;
+	dst->nvcsw += src->nvcsw;
+	dst->nivcsw += src->nivcsw;
+	dst->faults += src->faults;
+}
+
 /* Free the current process's resources. */
 static void
 process_cleanup(void)
@@ -834,12 +909,17 @@ install_page(void *upage, void *kpage, bool writable)
  * If you want to implement the function for only project 2, implement it on the
  * upper block. */
 
+/* 세그먼트 페이지의 첫 폴트. AUX(struct file_page)가 가리키는 파일
+ * 내용을 읽어 넣는다. 나머지는 anon_initializer()가 이미 0으로 채웠다. */
 static bool
 lazy_load_segment(struct page *page, void *aux)
 {
-	/* TODO: Load the segment from the file */
-	/* TODO: This called when the first page fault occurs on address VA. */
-	/* TODO: VA is available when calling this function. */
+	struct file_page *fp = aux;
+	bool success = file_read_at(fp->file, page->frame->kva, fp->read_bytes,
+								fp->ofs) == (off_t)fp->read_bytes;
+
+	file_page_free(fp);
+	return success;
 }
 
 /* Loads a segment starting at offset OFS in FILE at address
@@ -872,16 +952,42 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
 		size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
-		/* TODO: Set up aux to pass information to the lazy_load_segment. */
-		void *aux = NULL;
-		if (!vm_alloc_page_with_initializer(VM_ANON, upage,
-											writable, lazy_load_segment, aux))
+		/* 읽을 내용이 없는 bss 페이지는 0으로 채워질 익명 페이지라서
+		   읽기만 하면 공유 영 페이지로 끝난다 */
+		if (page_read_bytes == 0)
+		{
+			if (!vm_alloc_page(VM_ANON, upage, writable))
+				return false;
+			zero_bytes -= page_zero_bytes;
+			upage += PGSIZE;
+			continue;
+		}
+
+		/* 페이지마다 실행 파일 참조를 하나씩 가진다 */
+		struct file_page *aux = malloc(sizeof *aux);
+		if (aux == NULL)
 			return false;
+		aux->file = file_dup2(file);
+		aux->ofs = ofs;
+		aux->read_bytes = page_read_bytes;
+		aux->page_cnt = 0;
+		/* 읽기 전용 페이지는 파일 페이지로 두어 같은 실행 파일을 돌리는
+		   프로세스끼리 텍스트 캐시의 프레임을 나눠 쓰게 한다 */
+		if (!(writable
+				  ? vm_alloc_page_with_initializer(VM_ANON, upage, true,
+												   lazy_load_segment, aux)
+				  : vm_alloc_page_with_initializer(VM_FILE, upage, false,
+												   lazy_load_file, aux)))
+		{
+			file_page_free(aux);
+			return false;
+		}
 
 		/* Advance. */
 		read_bytes -= page_read_bytes;
 		zero_bytes -= page_zero_bytes;
 		upage += PGSIZE;
+		ofs += page_read_bytes;
 	}
 	return true;
 }
@@ -893,11 +999,12 @@ setup_stack(struct intr_frame *if_)
 	bool success = false;
 	void *stack_bottom = (void *)(((uint8_t *)USER_STACK) - PGSIZE);
 
-	/* TODO: Map the stack on stack_bottom and claim the page immediately.
-	 * TODO: If success, set the rsp accordingly.
-	 * TODO: You should mark the page is stack. */
-	/* TODO: Your code goes here */
-
+	/* 첫 스택 페이지는 인자를 바로 써 넣으므로 지연 없이 올린다 */
+	if (vm_alloc_page(VM_ANON, stack_bottom, true) && vm_claim_page(stack_bottom))
+	{
+		if_->rsp = USER_STACK;
+		success = true;
+	}
 	return success;
 }
 #endif /* VM */
@@ -20,6 +20,14 @@
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "devices/input.h"
+#include "threads/synch.h"
+#include <lockstat.h>
+#include <rusage.h>
+#include <clock.h>
+#include "devices/timer.h"
+#ifdef VM
+#include "vm/vm.h"
+#endif
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
@@ -34,10 +42,18 @@ int sys_write(int fd, const void *buffer, unsigned size);
 int sys_read(int fd, void *buffer, unsigned size);
 void sys_halt(void);
 int sys_dup2(int oldfd, int newfd);
+int sys_fdlimit(int max);
+int sys_lockstat(struct lockstat *buf, int max);
+int sys_getrusage(int who, struct rusage *usage);
+int sys_clock_gettime(int clock, struct timespec *ts);
+#ifdef VM
+void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset);
+#endif
 
 /* fd 할당/해제를 위한 함수 선언 */
 static int allocate_fd(struct file *f);
 static void free_fd(int fd);
+static struct file *fd_file(int fd);
 
 /* System call.
  *
@@ -76,6 +92,13 @@ void syscall_handler(struct intr_frame *f UNUSED)
 
 	int syscall_num = (int)f->R.rax;
 
+	/* 여기부터 유저 모드로 돌아갈 때까지는 커널 시간 */
+	thread_account_enter();
+#ifdef VM
+	/* 커널이 유저 버퍼에서 낸 폴트의 스택 확장 판단에 쓴다 */
+	thread_current()->user_rsp = f->rsp;
+#endif
+
 	switch (syscall_num)
 	{
 	/* void exit(int status); 호출 시 */
@@ -105,8 +128,16 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		/* buffer 가 cnt 바이트 연속으로 유효한지 (페이지 경계를 넘어가도) */
 		check_user_buffer((char *)buffer, size);
 
+#ifdef VM
+		/* 파일 락을 쥔 채 폴트가 나지 않도록 버퍼를 올려 고정 */
+		if (!vm_pin_buffer(buffer, size, false))
+			sys_exit(-1);
+#endif
 		/* 이제 안전하므로 출력 */
 		f->R.rax = sys_write(fd, buffer, size);
+#ifdef VM
+		vm_unpin_buffer(buffer, size);
+#endif
 		break;
 	}
 	/* int wait(tid_t tid); 호출 시	*/
@@ -165,7 +196,15 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		check_user_address(buffer);
 		check_user_buffer(buffer, size);
 
+#ifdef VM
+		/* 읽어 넣을 버퍼라 쓰기 가능해야 한다 */
+		if (!vm_pin_buffer(buffer, size, true))
+			sys_exit(-1);
+#endif
 		f->R.rax = sys_read(fd, buffer, size);
+#ifdef VM
+		vm_unpin_buffer(buffer, size);
+#endif
 
 		break;
 	}
@@ -218,9 +257,9 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_CLOSE:
 	{
 		int fd = (int)f->R.rdi;
-		if (fd > 1 && fd < MAX_FD && thread_current()->fd_table[fd])
+		if (fd > 1 && fd_file(fd))
 		{
-			file_close(thread_current()->fd_table[fd]);
+			file_close(fd_file(fd));
 
 			free_fd(fd);
 			f->R.rax = 0;
@@ -234,8 +273,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	{
 		int fd = (int)f->R.rdi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 
 		f->R.rax = fptr ? (off_t)file_length(fptr) : -1;
 
@@ -247,8 +286,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		int fd = (int)f->R.rdi;
 		unsigned pos = (unsigned)f->R.rsi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 		if (fptr)
 		{
 			file_seek(fptr, pos);
@@ -261,8 +300,8 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	{
 		int fd = (int)f->R.rdi;
 		struct file *fptr = NULL;
-		if (fd > 1 && fd < MAX_FD)
-			fptr = thread_current()->fd_table[fd];
+		if (fd > 1)
+			fptr = fd_file(fd);
 
 		f->R.rax = fptr ? (unsigned)file_tell(fptr) : -1;
 
@@ -276,22 +315,83 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		f->R.rax = sys_dup2(oldfd, newfd);
 		break;
 	}
+	/* int fdlimit(int max); 호출 시 */
+	case SYS_FDLIMIT:
+	{
+		int max = (int)f->R.rdi;
+		f->R.rax = sys_fdlimit(max);
+		break;
+	}
+	/* int lockstat(struct lockstat *buf, int max); 호출 시 */
+	case SYS_LOCKSTAT:
+	{
+		struct lockstat *buf = (struct lockstat *)f->R.rdi;
+		int max = (int)f->R.rsi;
+		f->R.rax = sys_lockstat(buf, max);
+		break;
+	}
+	/* int getrusage(int who, struct rusage *usage); 호출 시 */
+	case SYS_GETRUSAGE:
+	{
+		int who = (int)f->R.rdi;
+		struct rusage *usage = (struct rusage *)f->R.rsi;
+		f->R.rax = sys_getrusage(who, usage);
+		break;
+	}
+	/* int clock_gettime(int clock, struct timespec *ts); 호출 시 */
+	case SYS_CLOCK_GETTIME:
+	{
+		int clock = (int)f->R.rdi;
+		struct timespec *ts = (struct timespec *)f->R.rsi;
+		f->R.rax = sys_clock_gettime(clock, ts);
+		break;
+	}
+#ifdef VM
+	/* void *mmap(void *addr, size_t length, int writable, int fd, off_t offset); 호출 시 */
+	case SYS_MMAP:
+	{
+		void *addr = (void *)f->R.rdi;
+		size_t length = (size_t)f->R.rsi;
+		int writable = (int)f->R.rdx;
+		int fd = (int)f->R.r10;
+		off_t offset = (off_t)f->R.r8;
+		f->R.rax = (uint64_t)sys_mmap(addr, length, writable, fd, offset);
+		break;
+	}
+	/* void munmap(void *addr); 호출 시 */
+	case SYS_MUNMAP:
+	{
+		void *addr = (void *)f->R.rdi;
+		do_munmap(addr);
+		break;
+	}
+#endif
 	default:
 		sys_exit(-1);
 	}
+
+	thread_account_leave();
 }
 
 /*  check_user_address(const void *uaddr){}
 	널 포인터 차단 : !uaddr → NULL 이면 즉시 프로세스 종료
 	유저 영역 검사 : !is_user_vaddr(uaddr) → 주소가 `PHYS_BASE` 이상(커널 영역)에 있으면 종료
 	매핑 여부 검사 : pml4_get_page(..., uaddr) == NULL => 가상 → 물리 매핑이 안 돼 있으면 종료
+	VM에서는 아직 올라오지 않았어도 SPT에 있거나 스택을 키우는 접근이면 유효
 */
 void check_user_address(const void *uaddr)
 {
-	if (!uaddr || !is_user_vaddr(uaddr) || pml4_get_page(thread_current()->pml4, uaddr) == NULL)
-	{
+	struct thread *t = thread_current();
+
+	if (!uaddr || !is_user_vaddr(uaddr))
 		sys_exit(-1);
-	}
+#ifdef VM
+	if (pml4_get_page(t->pml4, uaddr) == NULL && spt_find_page(&t->spt, (void *)uaddr) == NULL && !vm_stack_access(uaddr, t->user_rsp))
+		sys_exit(-1);
+#else
+	if (pml4_get_page(t->pml4, uaddr) == NULL)
+		sys_exit(-1);
+#endif
 }
 
 /*	check_user_buffer(char *buffer, size_t size){}
@@ -340,9 +440,9 @@ int sys_write(int fd, const void *buffer, unsigned size)
 	// 1) 파일 디스크립터 테이블에 매핑된 파일이 있으면,
 	//    무조건 그 파일로 쓰기 (dup2로 덮어쓴 stdout 포함)
 	// 표준 출력 처리는 file_write에서 했음
-	if (fd >= 0 && fd < MAX_FD && thread_current()->fd_table[fd])
+	if (fd_file(fd))
 	{
-		ret = file_write(thread_current()->fd_table[fd], buffer, size);
+		ret = file_write(fd_file(fd), buffer, size);
 	}
 	else
 	{
@@ -363,9 +463,9 @@ int sys_read(int fd, void *buffer, unsigned size)
 	// 1) 파일 디스크립터 테이블에 매핑된 파일이 있으면,
 	//    무조건 그 파일로 쓰기 (dup2로 덮어쓴 stdin 포함)
 	// 표준 입력 처리는 file_read에서 했음
-	if (fd >= 0 && fd < MAX_FD && thread_current()->fd_table[fd])
+	if (fd_file(fd))
 	{
-		ret = file_read(thread_current()->fd_table[fd], buffer, size);
+		ret = file_read(fd_file(fd), buffer, size);
 	}
 	else
 	{
@@ -378,48 +478,139 @@ int sys_read(int fd, void *buffer, unsigned size)
 int sys_dup2(int oldfd, int newfd)
 {
 	struct thread *cur = thread_current();
-
-	// 유효성 검사
-	if (oldfd < 0 || oldfd >= MAX_FD || newfd < 0 || newfd >= MAX_FD)
-		return -1;
+	struct file *old = fd_file(oldfd);
 
 	// oldfd가 열려 있지 않으면 실패(EBADF)
-	if (cur->fd_table[oldfd] == NULL)
+	if (old == NULL)
 		return -1;
 
 	// fd 같으면 그냥 바로 리턴
 	if (oldfd == newfd)
 		return newfd;
 
-	// newfd 열려있다면 닫아주고
-	if (cur->fd_table[newfd] != NULL) // newfd가 열려있다면
-		file_close(cur->fd_table[newfd]);
+	// newfd가 상한을 넘으면 실패
+	if (newfd < 0 || newfd >= cur->fd_table.max)
+		return -1;
 
-	cur->fd_table[newfd] = file_dup2(cur->fd_table[oldfd]);
+	// newfd 열려있다면 닫아주고
+	if (fd_file(newfd) != NULL) // newfd가 열려있다면
+		file_close(fd_remove(&cur->fd_table, newfd));
 
+	if (!fd_install(&cur->fd_table, newfd, file_dup2(old)))
+	{
+		file_close(old);
+		return -1;
+	}
 	return newfd;
 }
 
-/* fd 할당 / 해제 헬퍼 함수*/
-static int allocate_fd(struct file *f)
+/* 열 수 있는 fd 상한을 MAX로 바꾸고 바뀐 상한을 반환.
+   MAX가 0 이하면 바꾸지 않고 현재 상한만 반환한다.
+   FD_MAX_LIMIT보다 크면 FD_MAX_LIMIT로 줄인다.
+   이미 MAX 이상의 fd가 열려 있으면 -1 */
+int sys_fdlimit(int max)
 {
-	struct thread *cur = thread_current();
-	for (int fd = cur->next_fd; fd < MAX_FD; fd++)
+	struct fd_table *t = &thread_current()->fd_table;
+
+	if (max > FD_MAX_LIMIT)
+		max = FD_MAX_LIMIT;
+	if (max > 0 && !fd_table_set_max(t, max))
+		return -1;
+	return t->max;
+}
+
+/* 경합이 심한 순으로 락 클래스 통계를 최대 MAX개 BUF에 복사하고 개수를 반환.
+   통계는 커널이 -lockstat으로 부팅했을 때만 쌓이며, 아니면 이름만 채워진다.
+   MAX는 먼저 클래스 수로 줄이고, 실제로 쓸 만큼만 BUF를 검사한다. */
+int sys_lockstat(struct lockstat *buf, int max)
+{
+	int cnt = lockstat_class_cnt();
+
+	if (max > cnt)
+		max = cnt;
+	if (max <= 0)
+		return 0;
+	if ((size_t)max > SIZE_MAX / sizeof *buf)
+		return -1;
+	check_user_buffer((char *)buf, (size_t)max * sizeof *buf);
+	return lockstat_snapshot(buf, max);
+}
+
+/* WHO가 RUSAGE_SELF면 현재 프로세스의, RUSAGE_CHILDREN이면 wait()으로
+   거둔 자식들(과 그 자손들)의 CPU 사용량을 USAGE에 복사한다.
+   성공하면 0, WHO가 잘못되었으면 -1. */
+int sys_getrusage(int who, struct rusage *usage)
+{
+	struct rusage r;
+
+	check_user_buffer((char *)usage, sizeof *usage);
+	if (who == RUSAGE_SELF)
+		thread_get_usage(&r);
+	else if (who == RUSAGE_CHILDREN)
 	{
-		if (cur->fd_table[fd] == NULL)
-		{
-			cur->fd_table[fd] = f;
-			cur->next_fd = fd + 1;
-			return fd;
-		}
+		/* 아직 거둔 자식이 없으면 모두 0 */
+		if (thread_current()->child_usage != NULL)
+			r = *thread_current()->child_usage;
+		else
+			memset(&r, 0, sizeof r);
 	}
-	return -1;
+	else
+		return -1;
+	memcpy(usage, &r, sizeof r);
+	return 0;
+}
+
+/* CLOCK이 CLOCK_MONOTONIC이면 부팅 후 지난 시간을, CLOCK_PROCESS_CPUTIME_ID면
+   현재 프로세스가 쓴 CPU 시간(유저+커널)을 ns 해상도로 TS에 쓴다.
+   둘 다 TSC로 잰다. 성공하면 0, CLOCK이 잘못되었으면 -1. */
+int sys_clock_gettime(int clock, struct timespec *ts)
+{
+	struct timespec t;
+	struct rusage r;
+	int64_t ns;
+
+	check_user_buffer((char *)ts, sizeof *ts);
+	if (clock == CLOCK_MONOTONIC)
+		ns = timer_ns();
+	else if (clock == CLOCK_PROCESS_CPUTIME_ID)
+	{
+		thread_get_usage(&r);
+		ns = timer_tsc_to_ns(r.utime + r.stime);
+	}
+	else
+		return -1;
+	t.tv_sec = ns / 1000000000;
+	t.tv_nsec = ns % 1000000000;
+	memcpy(ts, &t, sizeof t);
+	return 0;
+}
+
+#ifdef VM
+/* fd의 파일을 ADDR에 매핑하고 ADDR을 반환. 실패하면 NULL.
+   콘솔이나 길이가 0인 파일은 매핑할 수 없고 주소 검사는 do_mmap이 한다 */
+void *sys_mmap(void *addr, size_t length, int writable, int fd, off_t offset)
+{
+	struct file *file = fd_file(fd);
+
+	if (file == NULL || file == &console_in || file == &console_out || file_length(file) == 0)
+		return NULL;
+	return do_mmap(addr, length, writable, file, offset);
+}
+#endif
+
+/* fd 할당 / 해제 헬퍼 함수*/
+static int allocate_fd(struct file *f)
+{
+	return fd_alloc(&thread_current()->fd_table, f);
 }
 
 static void free_fd(int fd)
 {
-	struct thread *cur = thread_current();
-	cur->fd_table[fd] = NULL;
-	if (fd < cur->next_fd)
-		cur->next_fd = fd;
-}
\ No newline at end of file
+	fd_remove(&thread_current()->fd_table, fd);
+}
+
+/* 현재 프로세스의 FD에 열린 파일. 없으면 NULL */
+static struct file *fd_file(int fd)
+{
+	return fd_get(&thread_current()->fd_table, fd);
+}
@@ -2,7 +2,13 @@
 // anon.c: 디스크가 아닌 이미지(익명 페이지라고도 함)에 대한 페이지 구현을 담당합니다.
 
 #include "vm/vm.h"
+#include <bitmap.h>
+#include <stdio.h>
+#include <string.h>
 #include "devices/disk.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
 
 /* DO NOT MODIFY BELOW LINE */
 // ※ 해당 라인은 수정하지마세요. ※
@@ -20,41 +26,250 @@ static const struct page_operations anon_ops = {
 	.type = VM_ANON,
 };
 
+/* 페이지 하나를 담는 스왑 슬롯의 섹터 수. */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
+/* 미리 읽기 창. 폴트 난 슬롯이 속한 이만큼의 정렬된 슬롯 묶음에서
+   같은 프로세스의 페이지를 함께 읽는다. 함께 내보낸 페이지는 연속된
+   슬롯에 있으므로 보통 같은 묶음에 들어 있다. */
+#define READAHEAD_SLOTS 8
+
+/* 스왑 슬롯 할당.
+   swap_slots는 쓰고 있는 슬롯, slot_refs는 슬롯을 가진 페이지 수,
+   slot_owner는 미리 읽기에 쓰는 그중 한 페이지다(모르면 NULL).
+   셋과 통계는 swap_lock으로 보호한다. 슬롯의 내용은 쓸 때 한 번 쓰고
+   그 뒤로는 읽기만 하므로 입출력은 락 없이 한다. */
+static struct bitmap *swap_slots;
+static int *slot_refs;
+static struct page **slot_owner;
+static size_t slot_cnt;
+static struct lock swap_lock;
+
+/* 통계. */
+static long long swap_out_cnt;      /* 스왑에 쓴 페이지 수. */
+static long long swap_batch_cnt;    /* 그 쓰기 묶음 수. */
+static long long swap_in_cnt;       /* 스왑에서 읽은 페이지 수. */
+static long long swap_fault_cnt;    /* 스왑에서 읽어야 했던 폴트 수. */
+static long long readahead_cnt;     /* 미리 읽은 페이지 수. */
+
 /* Initialize the data for anonymous pages */
 // 익명 페이지에 대한 데이터 초기화를 수행합니다.
 void
 vm_anon_init (void) {
-	/* TODO: Set up the swap_disk. */
-	// swao_disk를 설정하세요.
-	swap_disk = NULL;
+	swap_disk = disk_get (1, 1);
+	lock_init (&swap_lock);
+	if (swap_disk == NULL)
+		return;
+
+	slot_cnt = disk_size (swap_disk) / SECTORS_PER_SLOT;
+	swap_slots = bitmap_create (slot_cnt);
+	slot_refs = calloc (slot_cnt, sizeof *slot_refs);
+	slot_owner = calloc (slot_cnt, sizeof *slot_owner);
+	if (swap_slots == NULL || slot_refs == NULL || slot_owner == NULL)
+		PANIC ("vm_anon_init: cannot allocate %zu swap slots", slot_cnt);
+}
+
+/* 익명 페이지를 내보낼 스왑 디스크가 있는가? */
+bool
+anon_swappable (void) {
+	return swap_disk != NULL;
 }
 
 /* Initialize the file mapping */
 // 파일 매핑을 초기화합니다.
+/* 익명 페이지는 0으로 채워진 채 시작한다. 실행 파일 세그먼트는
+   뒤이어 불리는 lazy_load_segment()가 내용을 읽어 넣는다. */
 bool
-anon_initializer (struct page *page, enum vm_type type, void *kva) {
+anon_initializer (struct page *page, enum vm_type type UNUSED, void *kva) {
 	/* Set up the handler */
 	page->operations = &anon_ops;
 
 	struct anon_page *anon_page = &page->anon;
+	anon_page->slot = SWAP_NONE;
+	anon_page->readahead = false;
+	memset (kva, 0, PGSIZE);
+	return true;
+}
+
+/* SLOT을 비운다. swap_lock을 쥔 채로 불러야 한다. */
+static void
+slot_free (size_t slot) {
+	bitmap_reset (swap_slots, slot);
+	slot_refs[slot] = 0;
+	slot_owner[slot] = NULL;
+}
+
+/* PAGE가 SLOT을 놓는다. 마지막 페이지였으면 슬롯을 비운다.
+   swap_lock을 쥔 채로 불러야 한다. */
+static void
+slot_put (size_t slot, struct page *page) {
+	ASSERT (slot_refs[slot] > 0);
+
+	if (--slot_refs[slot] == 0)
+		slot_free (slot);
+	else if (slot_owner[slot] == page)
+		slot_owner[slot] = NULL;
+}
+
+/* fork에서 부모의 스왑된 페이지 SRC의 슬롯을 자식 페이지 DST도
+   갖게 한다. 먼저 읽어 들이는 쪽이 자기 프레임을 받는다. */
+void
+anon_share_slot (struct page *dst, const struct page *src) {
+	ASSERT (src->anon.slot != SWAP_NONE);
+
+	lock_acquire (&swap_lock);
+	slot_refs[src->anon.slot]++;
+	lock_release (&swap_lock);
+	dst->anon.slot = src->anon.slot;
+}
+
+/* 스왑 미리 읽기. PAGE가 있던 SLOT의 READAHEAD_SLOTS 묶음에서 같은
+   프로세스의 다른 페이지를 빈 프레임이 있는 만큼 미리 올린다.
+   PAGE의 주인만 그 페이지들을 올리거나 해제하므로 찾은 페이지는
+   vm_prefetch_page()가 끝날 때까지 그대로 있다. */
+static void
+swap_readahead (struct page *page, size_t slot) {
+	size_t first = slot - slot % READAHEAD_SLOTS;
+	size_t i;
+
+	for (i = first; i < first + READAHEAD_SLOTS && i < slot_cnt; i++) {
+		struct page *near;
+
+		lock_acquire (&swap_lock);
+		near = slot_owner[i];
+		if (near != NULL && near->owner != page->owner)
+			near = NULL;
+		lock_release (&swap_lock);
+		if (near == NULL)
+			continue;
+
+		near->anon.readahead = true;
+		if (!vm_prefetch_page (near)) {
+			near->anon.readahead = false;
+			break;
+		}
+	}
 }
 
 /* Swap in the page by read contents from the swap disk. */
+/* 슬롯은 읽자마자 놓는다. 폴트로 불렸으면 이웃 슬롯을 미리 읽는다. */
 static bool
 anon_swap_in (struct page *page, void *kva) {
 	struct anon_page *anon_page = &page->anon;
+	size_t slot = anon_page->slot;
+	bool readahead = anon_page->readahead;
+	int i;
+
+	if (slot == SWAP_NONE)
+		return false;
+	for (i = 0; i < SECTORS_PER_SLOT; i++)
+		disk_read (swap_disk, slot * SECTORS_PER_SLOT + i,
+				(uint8_t *) kva + i * DISK_SECTOR_SIZE);
+
+	lock_acquire (&swap_lock);
+	slot_put (slot, page);
+	swap_in_cnt++;
+	if (readahead)
+		readahead_cnt++;
+	else
+		swap_fault_cnt++;
+	lock_release (&swap_lock);
+
+	anon_page->slot = SWAP_NONE;
+	anon_page->readahead = false;
+	if (!readahead)
+		swap_readahead (page, slot);
+	return true;
 }
 
 /* Swap out the page by writing contents to the swap disk. */
 // 스왑 디스크에서 내용을 읽어 페이지를 스왑합니다.
 static bool
 anon_swap_out (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
+	return anon_swap_out_cluster (&page->frame, 1);
+}
+
+/* FRAME을 매핑한 첫 페이지. */
+static struct page *
+frame_first_page (struct frame *frame) {
+	return list_entry (list_front (&frame->rmap), struct page, rmap_elem);
+}
+
+/* 익명 프레임 FRAMES[0..CNT)를 스왑에 쓴다.
+   되도록 연속된 슬롯을 한 번에 잡아 차례로 쓰고, 그만큼 연속된 자리가
+   없으면 슬롯을 하나씩 잡는다. 슬롯이 모자라면 아무것도 쓰지 않고
+   false. 프레임마다 슬롯 하나에 한 번 쓰고 그 프레임을 나눠 쓰던
+   페이지 모두가 슬롯을 갖는다. 매핑은 모두 지우지만 rmap과 프레임은
+   호출자가 정리한다. */
+bool
+anon_swap_out_cluster (struct frame **frames, size_t cnt) {
+	size_t slots[SWAP_CLUSTER];
+	size_t first, i;
+	struct list_elem *e;
+	int j;
+
+	ASSERT (swap_disk != NULL);
+	ASSERT (cnt <= SWAP_CLUSTER);
+
+	lock_acquire (&swap_lock);
+	first = bitmap_scan_and_flip (swap_slots, 0, cnt, false);
+	for (i = 0; i < cnt; i++) {
+		slots[i] = first != BITMAP_ERROR ? first + i
+			: bitmap_scan_and_flip (swap_slots, 0, 1, false);
+		if (slots[i] == BITMAP_ERROR) {
+			while (i-- > 0)
+				slot_free (slots[i]);
+			lock_release (&swap_lock);
+			return false;
+		}
+		slot_refs[slots[i]] = frames[i]->ref_cnt;
+		slot_owner[slots[i]] = frame_first_page (frames[i]);
+	}
+	swap_out_cnt += cnt;
+	swap_batch_cnt++;
+	lock_release (&swap_lock);
+
+	for (i = 0; i < cnt; i++)
+		for (e = list_begin (&frames[i]->rmap); e != list_end (&frames[i]->rmap);
+				e = list_next (e))
+			vm_unmap_page (list_entry (e, struct page, rmap_elem));
+	for (i = 0; i < cnt; i++) {
+		void *kva = frames[i]->kva;
+
+		for (j = 0; j < SECTORS_PER_SLOT; j++)
+			disk_write (swap_disk, slots[i] * SECTORS_PER_SLOT + j,
+					(uint8_t *) kva + j * DISK_SECTOR_SIZE);
+		for (e = list_begin (&frames[i]->rmap); e != list_end (&frames[i]->rmap);
+				e = list_next (e))
+			list_entry (e, struct page, rmap_elem)->anon.slot = slots[i];
+	}
+	return true;
 }
 
 /* Destroy the anonymous page. PAGE will be freed by the caller. */
 // 익명 페이지를 삭제합니다. 호출자가 PAGE를 해제합니다.
+/* 스왑에 있던 페이지는 슬롯을 바로 놓는다. */
 static void
 anon_destroy (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
+
+	if (page->frame != NULL)
+		vm_unmap_page (page);
+	else if (anon_page->slot != SWAP_NONE) {
+		lock_acquire (&swap_lock);
+		slot_put (anon_page->slot, page);
+		lock_release (&swap_lock);
+	}
+}
+
+/* 스왑 통계를 출력한다. 폴트당 읽은 페이지 수에는 미리 읽기가 포함된다. */
+void
+anon_print_stats (void) {
+	long long per_fault = swap_fault_cnt > 0
+		? swap_in_cnt * 100 / swap_fault_cnt : 0;
+
+	printf ("Swap: %lld pages out in %lld batches, %lld pages in "
+			"(%lld read ahead), %lld.%02lld pages read per fault\n",
+			swap_out_cnt, swap_batch_cnt, swap_in_cnt, readahead_cnt,
+			per_fault / 100, per_fault % 100);
 }
@@ -2,6 +2,10 @@
 // file.c: 메모리 백업 파일 객체(mmaped 객체)의 구현입니다.
 
 #include "vm/vm.h"
+#include <round.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
@@ -24,44 +28,186 @@ vm_file_init (void) {
 
 /* Initialize the file backed page */
 // 파일 백업 페이지 초기화합니다.
+/* 파일 정보는 뒤이어 불리는 init(lazy_load_file)이나 fork가 채운다. */
 bool
-file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
+file_backed_initializer (struct page *page, enum vm_type type UNUSED,
+		void *kva UNUSED) {
 	/* Set up the handler */
 	page->operations = &file_ops;
 
 	struct file_page *file_page = &page->file;
+	memset (file_page, 0, sizeof *file_page);
+	return true;
+}
+
+/* mmap 페이지와 읽기 전용 실행 파일 세그먼트의 첫 폴트. AUX의 파일
+   정보를 페이지로 옮기고 내용을 읽는다. 파일 참조도 함께 옮겨 간다. */
+bool
+lazy_load_file (struct page *page, void *aux) {
+	struct file_page *file_page = aux;
+
+	page->file = *file_page;
+	free (file_page);
+	return file_backed_swap_in (page, page->frame->kva);
 }
 
 /* Swap in the page by read contents from the file. */
 // 파일에서 내용을 읽어 페이지를 교체합니다.
 static bool
 file_backed_swap_in (struct page *page, void *kva) {
-	struct file_page *file_page UNUSED = &page->file;
+	struct file_page *file_page = &page->file;
+
+	if (file_read_at (file_page->file, kva, file_page->read_bytes,
+				file_page->ofs) != (off_t) file_page->read_bytes)
+		return false;
+	memset ((uint8_t *) kva + file_page->read_bytes, 0,
+			PGSIZE - file_page->read_bytes);
+	return true;
 }
 
 /* Swap out the page by writeback contents to the file. */
 // 파일에 쓰기백 내용으로 페이지를 교체합니다.
+/* 매핑을 먼저 지우고, 더러웠으면 파일 크기 안쪽만 되돌려 쓴다. */
 static bool
 file_backed_swap_out (struct page *page) {
-	struct file_page *file_page UNUSED = &page->file;
+	struct file_page *file_page = &page->file;
+
+	if (vm_unmap_page (page))
+		file_write_at (file_page->file, page->frame->kva,
+				file_page->read_bytes, file_page->ofs);
+	return true;
 }
 
 /* Destory the file backed page. PAGE will be freed by the caller. */
 // 파일 백 페이지를 파괴합니다. 호출자가 PAGE를 해제합니다.
 static void
 file_backed_destroy (struct page *page) {
-	struct file_page *file_page UNUSED = &page->file;
+	struct file_page *file_page = &page->file;
+
+	if (page->frame != NULL)
+		file_backed_swap_out (page);
+	file_close (file_page->file);
+}
+
+/* SRC를 새로 할당한 struct file_page에 복제한다. 파일 참조도 하나
+   늘린다. 메모리가 부족하면 NULL. */
+struct file_page *
+file_page_dup (const struct file_page *src) {
+	struct file_page *dst = malloc (sizeof *dst);
+
+	if (dst != NULL) {
+		*dst = *src;
+		dst->file = file_dup2 (src->file);
+	}
+	return dst;
+}
+
+/* file_page_dup()이나 malloc으로 만든 FILE_PAGE와 그 파일 참조를
+   해제한다. FILE_PAGE가 NULL이면 아무것도 하지 않는다. */
+void
+file_page_free (struct file_page *file_page) {
+	if (file_page != NULL) {
+		file_close (file_page->file);
+		free (file_page);
+	}
+}
+
+/* uninit이든 초기화되었든 파일 페이지 PAGE의 파일 정보. */
+struct file_page *
+page_file_info (struct page *page) {
+	if (VM_TYPE (page->operations->type) == VM_UNINIT)
+		return page->uninit.aux;
+	return &page->file;
+}
+
+/* uninit 파일 페이지 PAGE를 내용을 읽지 않고 파일 페이지로 바꾼다.
+   같은 내용을 담은 프레임을 나눠 쓸 때 부른다. */
+void
+file_backed_adopt (struct page *page) {
+	struct file_page *aux = page->uninit.aux;
+
+	ASSERT (VM_TYPE (page->operations->type) == VM_UNINIT);
+	ASSERT (page->uninit.init == lazy_load_file);
+
+	file_backed_initializer (page, VM_FILE, NULL);
+	page->file = *aux;
+	free (aux);
 }
 
 /* Do the mmap */
 // mmap 관련 기능입니다.
+/* FILE의 OFFSET부터 LENGTH 바이트를 ADDR에 지연 로딩으로 매핑한다.
+   FILE을 다시 열어 쓰므로 호출자가 FILE을 닫아도 매핑은 남는다.
+   파일 끝을 넘는 부분은 0으로 채우고 되돌려 쓰지 않는다.
+   ADDR이 페이지 정렬이 아니거나 이미 쓰는 페이지와 겹치면 NULL. */
 void *
 do_mmap (void *addr, size_t length, int writable,
 		struct file *file, off_t offset) {
+	size_t page_cnt = DIV_ROUND_UP (length, PGSIZE);
+	uint8_t *upage = addr;
+	struct file *mfile;
+	off_t file_len;
+	size_t i;
+
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0
+			|| offset < 0 || pg_ofs (offset) != 0
+			|| !is_user_vaddr (addr) || (uintptr_t) addr + length < (uintptr_t) addr
+			|| !is_user_vaddr ((uint8_t *) addr + page_cnt * PGSIZE - 1))
+		return NULL;
+	for (i = 0; i < page_cnt; i++)
+		if (spt_find_page (&thread_current ()->spt, upage + i * PGSIZE) != NULL)
+			return NULL;
+
+	mfile = file_reopen (file);
+	if (mfile == NULL)
+		return NULL;
+	file_len = file_length (mfile);
+
+	for (i = 0; i < page_cnt; i++) {
+		struct file_page *aux = malloc (sizeof *aux);
+		off_t ofs = offset + i * PGSIZE;
+
+		if (aux == NULL)
+			break;
+		aux->file = file_dup2 (mfile);
+		aux->ofs = ofs;
+		aux->read_bytes = ofs >= file_len ? 0
+			: file_len - ofs < PGSIZE ? (size_t) (file_len - ofs) : PGSIZE;
+		aux->page_cnt = i == 0 ? page_cnt : 0;
+		if (!vm_alloc_page_with_initializer (VM_FILE, upage + i * PGSIZE,
+					writable, lazy_load_file, aux)) {
+			file_page_free (aux);
+			break;
+		}
+	}
+	file_close (mfile);
+
+	if (i < page_cnt) {
+		while (i-- > 0)
+			spt_remove_page (&thread_current ()->spt,
+					spt_find_page (&thread_current ()->spt, upage + i * PGSIZE));
+		return NULL;
+	}
+	return addr;
 }
 
 /* Do the munmap */
 // munamp 관련 기능입니다.
+/* ADDR에서 시작하는 매핑을 모두 푼다. 더러운 페이지는 되돌려 쓴다.
+   ADDR이 do_mmap()이 돌려준 주소가 아니면 아무것도 하지 않는다. */
 void
 do_munmap (void *addr) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct page *page = spt_find_page (spt, addr);
+	size_t page_cnt, i;
+
+	if (page == NULL || pg_ofs (addr) != 0 || page_get_type (page) != VM_FILE)
+		return;
+	page_cnt = page_file_info (page)->page_cnt;
+
+	for (i = 0; i < page_cnt; i++) {
+		page = spt_find_page (spt, (uint8_t *) addr + i * PGSIZE);
+		if (page != NULL)
+			spt_remove_page (spt, page);
+	}
 }
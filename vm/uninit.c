@@ -77,10 +77,10 @@ uninit_initialize (struct page *page, void *kva) {
  * 대부분의 페이지는 다른 페이지 객체로 변환되지만,
  * 프로세스 종료 시 실행 중에 참조되지 않는 uninit 페이지가 생성될 수 있습니다.
  * PAGE는 호출자에 의해 해제됩니다. */
+/* 이 트리에서 AUX는 NULL이거나 지연 로딩 정보를 담은 struct file_page다. */
 static void
 uninit_destroy (struct page *page) {
-	struct uninit_page *uninit UNUSED = &page->uninit;
-	/* TODO: Fill this function.
-	 * TODO: If you don't have anything to do, just return. */
-	// 할 것이 없으면 그냥 작성 안해도됩니다.
+	struct uninit_page *uninit = &page->uninit;
+
+	file_page_free (uninit->aux);
 }
@@ -1,9 +1,80 @@
 /* vm.c: 가상 메모리 객체를 위한 일반 인터페이스. */
 
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/file.h"
 #include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
 
+/* 스택이 자랄 수 있는 최대 크기. */
+#define STACK_MAX (1 << 20)
+
+/* 더러운 후보를 찾은 뒤 깨끗한 프레임을 더 찾아볼 프레임 수.
+   더러운 페이지는 내보낼 때 쓰기가 필요하므로 가까이에 깨끗한 페이지가
+   있으면 그쪽을 고르되, 한 번의 선택이 이만큼 넘게 걸리지는 않는다. */
+#define CLEAN_WINDOW 16
+
+/* 익명 페이지를 내보낼 때 SWAP_CLUSTER개까지 함께 모으며 바늘이
+   움직일 최대 거리. */
+#define SWAP_SCAN (4 * SWAP_CLUSTER)
+
+/* 전역 프레임 테이블.
+   유저 풀에서 받은 모든 프레임이 들어 있고, clock_hand가 이 리스트를
+   원형으로 돌며 내보낼 프레임을 고른다. 새 프레임은 바늘 바로 뒤에
+   넣어 가장 늦게 검사되게 한다.
+   리스트, 바늘, 프레임의 rmap/ref_cnt/pin_cnt, 페이지의 frame은 모두
+   frame_lock으로 보호한다. 내보내기는 쓰기가 끝날 때까지 frame_lock을
+   쥐고 있으므로 그 페이지에 폴트를 낸 스레드는 쓰기가 끝난 뒤에야
+   새 프레임을 받는다. */
+static struct list frame_list;
+static struct list_elem *clock_hand;
+static struct lock frame_lock;
+static size_t frame_cnt;
+
+/* 통계. frame_lock으로 보호한다. */
+static long long page_in_cnt;       /* 프레임에 올린 페이지 수. */
+static long long evict_cnt;         /* 내보낸 페이지 수. */
+static long long evict_clean_cnt;   /* 그중 쓰기 없이 내보낸 수. */
+static long long cow_copy_cnt;      /* 복사한 copy-on-write 폴트 수. */
+static long long cow_reuse_cnt;     /* 복사 없이 끝난 copy-on-write 폴트 수. */
+static long long zero_map_cnt;      /* 영 페이지로 처리한 읽기 폴트 수. */
+static long long zero_break_cnt;    /* 그중 나중에 자기 프레임을 받은 수. */
+
+/* 공유 영 페이지. 0으로 채운 프레임 하나를 아직 쓰이지 않은 익명
+   페이지의 읽기 폴트마다 읽기 전용으로 매핑한다. 프레임 테이블에
+   넣지 않으므로 내보내지지 않는다. 첫 쓰기에서 페이지는 자기 프레임을
+   받는다. */
+static void *zero_kva;
+
+/* 텍스트 캐시.
+   읽기 전용 파일 페이지를 담은 프레임을 (inode, 오프셋)으로 찾는 해시
+   테이블이다. 같은 실행 파일을 돌리는 프로세스들은 코드와 읽기 전용
+   데이터를 프레임 하나로 나눠 쓴다. 프레임은 매핑한 페이지가 있는
+   동안만 캐시에 있으므로 그 페이지들의 파일 참조가 inode를 붙잡고
+   있다. 프레임이 내보내지거나 해제되면 캐시에서 빠지고, inode에
+   쓰거나 inode를 지우면 그 부분의 프레임이 캐시에서 빠진다.
+   캐시와 프레임의 text_inode는 text_lock으로 보호한다. inode에 쓰는
+   쪽은 frame_lock을 쥔 내보내기 안에서도 불리므로 text_lock은
+   frame_lock 다음에 잡고, text_lock을 쥔 채 다른 락을 잡지 않는다.
+   text_gen은 무효화마다 늘어, 읽는 동안 무효화된 내용을 캐시에
+   넣지 않게 한다. */
+static struct hash text_cache;
+static struct lock text_lock;
+static unsigned text_gen;
+static size_t text_cnt;             /* 캐시에 있는 프레임 수. */
+static long long text_share_cnt;    /* 캐시에서 찾아 매핑한 폴트 수. */
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+static hash_action_func page_destructor;
+static hash_hash_func text_hash;
+static hash_less_func text_less;
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 // 각 하위 시스템의 초기화 코드를 호출하여 가상 메모리 하위 시스템을 초기화합니다.
@@ -17,13 +88,18 @@ vm_init (void) {
 	register_inspect_intr ();
 	/* DO NOT MODIFY UPPER LINES. */
 	// ※ 위의 라인은 수정하지마세요. ※
-	/* TODO: Your code goes here. */
+	list_init (&frame_list);
+	clock_hand = list_end (&frame_list);
+	lock_init (&frame_lock);
+	zero_kva = palloc_get_page (PAL_USER | PAL_ZERO | PAL_ASSERT);
+	hash_init (&text_cache, text_hash, text_less, NULL);
+	lock_init (&text_lock);
 }
 
 /* Get the type of the page. This function is useful if you want to know the
  * type of the page after it will be initialized.
  * This function is fully implemented now. */
-// 페이지 유형을 가져옵니다. 이 함수는 페이지가 초기화된 후 페이지의 유형을 알고 싶을 때 유용합니다. 
+// 페이지 유형을 가져옵니다. 이 함수는 페이지가 초기화된 후 페이지의 유형을 알고 싶을 때 유용합니다.
 // 이 함수는 현재 완전히 구현되었습니다.
 enum vm_type
 page_get_type (struct page *page) {
@@ -39,13 +115,18 @@ page_get_type (struct page *page) {
 /* Helpers */
 static struct frame *vm_get_victim (void);
 static bool vm_do_claim_page (struct page *page);
+static bool vm_claim_frame (struct page *page);
 static struct frame *vm_evict_frame (void);
+static void vm_free_page (struct page *page);
+static bool vm_map_frame (struct page *page, struct frame *frame);
+static bool vm_handle_wp (struct page *page);
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or
  * `vm_alloc_page`. */
-// 초기화 함수를 사용하여 보류 중인 페이지 객체를 생성합니다. 
+// 초기화 함수를 사용하여 보류 중인 페이지 객체를 생성합니다.
 // 페이지를 생성하려면 직접 생성하지 말고 이 함수나 `vm_alloc_page`를 통해 생성하세요.
+// 실패하면 AUX는 호출자가 해제해야 합니다.
 bool
 vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 		vm_initializer *init, void *aux) {
@@ -57,14 +138,33 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 	/* Check wheter the upage is already occupied or not. */
 	// 이미지가 이미 점유되어 있는지 확인하세요.
 	if (spt_find_page (spt, upage) == NULL) {
-		/* TODO: Create the page, fetch the initialier according to the VM type,
-		 * TODO: and then create "uninit" page struct by calling uninit_new. You
-		 * TODO: should modify the field after calling the uninit_new. */
-		// 해야될 것: 페이지를 생성하고, VM 유형에 따라 초기화 파일을 가져온 후, uninit_new를 호출하여 "uninit" 페이지 구조체를 생성합니다.
-		// 해야될 것: uninit_new를 호출한 후 필드를 수정해야 합니다.
+		bool (*initializer) (struct page *, enum vm_type, void *);
+		struct page *page;
 
-		/* TODO: Insert the page into the spt. */
-		// 해당 페이지를 spt에 삽입합니다.
+		switch (VM_TYPE (type)) {
+			case VM_ANON:
+				initializer = anon_initializer;
+				break;
+			case VM_FILE:
+				initializer = file_backed_initializer;
+				break;
+			default:
+				goto err;
+		}
+
+		page = malloc (sizeof *page);
+		if (page == NULL)
+			goto err;
+		uninit_new (page, upage, init, type, aux, initializer);
+		page->owner = thread_current ();
+		page->writable = writable;
+		page->zero = false;
+
+		if (!spt_insert_page (spt, page)) {
+			free (page);
+			goto err;
+		}
+		return true;
 	}
 err:
 	return false;
@@ -73,52 +173,300 @@ err:
 /* Find VA from spt and return page. On error, return NULL. */
 // spt에서 VA를 찾아 페이지를 반환합니다. 오류가 발생하면 NULL을 반환합니다.
 struct page *
-spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
-	struct page *page = NULL;
-	/* TODO: Fill this function. */
-	// 기능을 구현하세요.
+spt_find_page (struct supplemental_page_table *spt, void *va) {
+	struct page key;
+	struct hash_elem *e;
 
-	return page;
+	key.va = pg_round_down (va);
+	e = hash_find (&spt->pages, &key.spt_elem);
+	return e != NULL ? hash_entry (e, struct page, spt_elem) : NULL;
 }
 
 /* Insert PAGE into spt with validation. */
 // 검증을 통해 spt에 PAGE를 삽입합니다.
 bool
-spt_insert_page (struct supplemental_page_table *spt UNUSED,
-		struct page *page UNUSED) {
-	int succ = false;
-	/* TODO: Fill this function. */
-
-	return succ;
+spt_insert_page (struct supplemental_page_table *spt,
+		struct page *page) {
+	return hash_insert (&spt->pages, &page->spt_elem) == NULL;
 }
 
+/* PAGE를 SPT에서 빼고 해제한다. 프레임에 있었다면 파일 페이지는
+   되돌려 쓰고 프레임을 돌려준다. */
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
-	vm_dealloc_page (page);
-	return true;
+	hash_delete (&spt->pages, &page->spt_elem);
+	vm_free_page (page);
+}
+
+/* FRAME이 텍스트 캐시에 있으면 뺀다. text_lock을 쥔 채로 불러야 한다. */
+static void
+text_remove (struct frame *frame) {
+	if (frame->text_inode != NULL) {
+		hash_delete (&text_cache, &frame->text_elem);
+		frame->text_inode = NULL;
+		text_cnt--;
+	}
+}
+
+/* FRAME을 텍스트 캐시에서 뺀다. */
+static void
+frame_uncache (struct frame *frame) {
+	lock_acquire (&text_lock);
+	text_remove (frame);
+	lock_release (&text_lock);
+}
+
+/* FRAME을 프레임 테이블과 텍스트 캐시에서 뺀다. 바늘이 FRAME을
+   가리키면 다음으로 옮긴다. frame_lock을 쥔 채로 불러야 한다. */
+static void
+frame_table_remove (struct frame *frame) {
+	frame_uncache (frame);
+	if (clock_hand == &frame->elem)
+		clock_hand = list_next (clock_hand);
+	list_remove (&frame->elem);
+	frame_cnt--;
+}
+
+/* PAGE를 FRAME의 rmap에 잇는다. frame_lock을 쥔 채로 불러야 한다. */
+static void
+frame_link (struct frame *frame, struct page *page) {
+	list_push_back (&frame->rmap, &page->rmap_elem);
+	frame->ref_cnt++;
+	page->frame = frame;
+}
+
+/* PAGE를 FRAME의 rmap에서 뺀다. frame_lock을 쥔 채로 불러야 한다. */
+static void
+frame_unlink (struct frame *frame, struct page *page) {
+	ASSERT (page->frame == frame);
+
+	list_remove (&page->rmap_elem);
+	frame->ref_cnt--;
+	page->frame = NULL;
+}
+
+/* FRAME을 매핑한 첫 페이지. 나눠 쓰는 페이지는 모두 같은 종류다. */
+static struct page *
+frame_page (struct frame *frame) {
+	return list_entry (list_front (&frame->rmap), struct page, rmap_elem);
+}
+
+/* FRAME의 페이지 종류. */
+static enum vm_type
+frame_type (struct frame *frame) {
+	return VM_TYPE (frame_page (frame)->operations->type);
+}
+
+/* FRAME을 매핑한 페이지 중 하나라도 최근에 쓰였는가? 모두의 accessed
+   비트를 끄므로 다음에 물으면 그 사이에 쓰였는지를 답한다. */
+static bool
+frame_accessed (struct frame *frame) {
+	bool accessed = false;
+	struct list_elem *e;
+
+	for (e = list_begin (&frame->rmap); e != list_end (&frame->rmap);
+			e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, rmap_elem);
+		uint64_t *pml4 = page->owner->pml4;
+
+		if (pml4_is_accessed (pml4, page->va)) {
+			pml4_set_accessed (pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+/* FRAME이 지금 내보낼 수 있는 프레임인가?
+   스왑 디스크가 없으면 익명 페이지는 내보낼 곳이 없다. */
+static bool
+frame_evictable (struct frame *frame) {
+	return frame->pin_cnt == 0 && frame->ref_cnt > 0
+		&& (frame_type (frame) == VM_FILE || anon_swappable ());
+}
+
+/* FRAME을 내보내려면 쓰기가 필요한가? 익명 페이지는 늘 스왑에
+   써야 하고, 파일 페이지는 더러울 때만 되돌려 쓴다. 파일 페이지는
+   나눠 쓰지 않는다. */
+static bool
+frame_needs_write (struct frame *frame) {
+	struct page *page = frame_page (frame);
+
+	return frame_type (frame) == VM_ANON
+		|| pml4_is_dirty (page->owner->pml4, page->va);
 }
 
 /* Get the struct frame, that will be evicted. */
 // 내보낼 구조체 프레임을 가져옵니다.
+/* 개선된 clock(second chance).
+   바늘이 지나가며 accessed 비트가 켜진 프레임은 비트를 끄고 한 번 더
+   기회를 준다. 꺼져 있는 프레임 중 깨끗한 것은 바로 고르고, 더러운
+   것은 후보로 기억해 두고 CLEAN_WINDOW개를 더 보며 깨끗한 것을 찾는다.
+   한 바퀴 돌면 모든 accessed 비트가 꺼지므로 두 바퀴 안에 끝나고,
+   비트 하나를 끄는 일은 그 페이지가 한 번 쓰였을 때만 생기므로 선택
+   한 번의 비용은 분할 상환 O(1)이다. 나눠 쓰는 프레임은 매핑한
+   페이지 중 하나라도 쓰였으면 기회를 준다. 내보낼 프레임이 없으면 NULL.
+   frame_lock을 쥔 채로 불러야 한다. */
 static struct frame *
 vm_get_victim (void) {
-	struct frame *victim = NULL;
-	 /* TODO: The policy for eviction is up to you. */
-	 // 내보내는 규칙은 본인이 정하세요.
+	struct frame *dirty = NULL;
+	size_t window = 0;
+	size_t i;
 
-	return victim;
+	for (i = 0; i < 2 * frame_cnt + 1; i++) {
+		struct frame *frame;
+
+		if (clock_hand == list_end (&frame_list))
+			clock_hand = list_begin (&frame_list);
+		if (clock_hand == list_end (&frame_list))
+			break;
+		frame = list_entry (clock_hand, struct frame, elem);
+		clock_hand = list_next (clock_hand);
+
+		if (dirty != NULL && ++window > CLEAN_WINDOW)
+			break;
+		if (!frame_evictable (frame) || frame_accessed (frame))
+			continue;
+		if (!frame_needs_write (frame))
+			return frame;
+		if (dirty == NULL)
+			dirty = frame;
+	}
+	return dirty;
+}
+
+/* 익명 희생 프레임과 함께 스왑에 쓸 익명 프레임을 바늘 앞에서 최대
+   MAX개 더 모아 고정한 뒤 BATCH에 넣고 그 개수를 반환한다. 바늘은
+   SWAP_SCAN 프레임까지만 움직이고, 최근에 쓰인 프레임은 vm_get_victim()
+   처럼 accessed 비트를 끄고 건너뛴다. frame_lock을 쥔 채로 불러야 한다. */
+static size_t
+vm_gather_anon (struct frame **batch, size_t max) {
+	size_t cnt = 0;
+	size_t i;
+
+	for (i = 0; i < SWAP_SCAN && cnt < max; i++) {
+		struct frame *frame;
+
+		if (clock_hand == list_end (&frame_list))
+			clock_hand = list_begin (&frame_list);
+		if (clock_hand == list_end (&frame_list))
+			break;
+		frame = list_entry (clock_hand, struct frame, elem);
+		clock_hand = list_next (clock_hand);
+
+		if (!frame_evictable (frame) || frame_type (frame) != VM_ANON
+				|| frame_accessed (frame))
+			continue;
+		frame->pin_cnt++;
+		batch[cnt++] = frame;
+	}
+	return cnt;
+}
+
+/* FRAME의 rmap을 비운다. frame_lock을 쥔 채로 불러야 한다. */
+static void
+frame_unlink_all (struct frame *frame) {
+	while (!list_empty (&frame->rmap))
+		frame_unlink (frame, frame_page (frame));
+}
+
+/* 익명 프레임 VICTIM을 이웃 익명 프레임들과 함께 연속된 스왑 슬롯에
+   내보낸다. VICTIM을 뺀 나머지 프레임은 유저 풀에 돌려주므로 뒤따르는
+   폴트는 내보내기 없이 프레임을 얻는다. frame_lock을 쥔 채로 불러야
+   하고 VICTIM은 고정되어 있어야 한다. */
+static bool
+vm_evict_anon (struct frame *victim) {
+	struct frame *batch[SWAP_CLUSTER];
+	size_t cnt, i;
+
+	batch[0] = victim;
+	cnt = 1 + vm_gather_anon (batch + 1, SWAP_CLUSTER - 1);
+
+	if (!anon_swap_out_cluster (batch, cnt)) {
+		for (i = 1; i < cnt; i++)
+			batch[i]->pin_cnt--;
+		return false;
+	}
+
+	for (i = 1; i < cnt; i++) {
+		frame_unlink_all (batch[i]);
+		frame_table_remove (batch[i]);
+		palloc_free_page (batch[i]->kva);
+		free (batch[i]);
+	}
+	evict_cnt += cnt - 1;
+	return true;
+}
+
+/* 파일 프레임 VICTIM을 매핑한 페이지를 모두 내보낸다. 나눠 쓰는 파일
+   프레임은 읽기 전용이라 되돌려 쓸 것이 없다. frame_lock을 쥔 채로
+   불러야 한다. */
+static bool
+vm_evict_file (struct frame *victim) {
+	struct list_elem *e;
+
+	for (e = list_begin (&victim->rmap); e != list_end (&victim->rmap);
+			e = list_next (e))
+		if (!swap_out (list_entry (e, struct page, rmap_elem)))
+			return false;
+	return true;
 }
 
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 // 한 페이지를 제거하고 해당 프레임을 반환합니다.
 // 오류 발생 시 NULL을 반환합니다.
+/* 돌려주는 프레임은 테이블에 남아 있고 고정되어 있다.
+   frame_lock을 쥔 채로 불러야 한다. */
 static struct frame *
 vm_evict_frame (void) {
-	struct frame *victim UNUSED = vm_get_victim ();
-	/* TODO: swap out the victim and return the evicted frame. */
+	struct frame *victim = vm_get_victim ();
+	bool clean;
+	bool success;
+
+	if (victim == NULL)
+		return NULL;
+	clean = !frame_needs_write (victim);
+
+	victim->pin_cnt++;
+	if (frame_type (victim) == VM_ANON)
+		success = vm_evict_anon (victim);
+	else
+		success = vm_evict_file (victim);
+	if (!success) {
+		victim->pin_cnt--;
+		return NULL;
+	}
+	frame_unlink_all (victim);
+	frame_uncache (victim);
+
+	evict_cnt++;
+	if (clean)
+		evict_clean_cnt++;
+	return victim;
+}
+
+/* KVA를 담은 프레임을 만들어 바늘 바로 뒤에 넣는다. 프레임은 한 번
+   고정된 채로 돌려준다. 메모리가 부족하면 KVA를 돌려주고 NULL. */
+static struct frame *
+frame_alloc (void *kva) {
+	struct frame *frame = malloc (sizeof *frame);
 
-	return NULL;
+	if (frame == NULL) {
+		palloc_free_page (kva);
+		return NULL;
+	}
+	frame->kva = kva;
+	list_init (&frame->rmap);
+	frame->ref_cnt = 0;
+	frame->pin_cnt = 1;
+	frame->text_inode = NULL;
+
+	lock_acquire (&frame_lock);
+	list_insert (clock_hand, &frame->elem);
+	frame_cnt++;
+	lock_release (&frame_lock);
+	return frame;
 }
 
 /* palloc() and get frame. If there is no available page, evict the page
@@ -126,48 +474,213 @@ vm_evict_frame (void) {
  * memory is full, this function evicts the frame to get the available memory
  * space.*/
 // palloc() 함수는 프레임을 가져옵니다. 사용 가능한 페이지가 없으면 해당 페이지를 제거하고 반환합니다.
-// 이 함수는 항상 유효한 주소를 반환합니다. 
+// 이 함수는 항상 유효한 주소를 반환합니다.
 // 즉, 사용자 풀 메모리가 가득 차면 이 함수는 프레임을 제거하여 사용 가능한 메모리 공간을 가져옵니다.
+/* 돌려주는 프레임은 프레임 테이블에 들어 있고 한 번 고정되어 있다.
+   모든 프레임이 고정되어 있거나 내보낼 수 없으면 NULL. */
 static struct frame *
 vm_get_frame (void) {
-	struct frame *frame = NULL;
-	/* TODO: Fill this function. */
+	struct frame *frame;
+	void *kva = palloc_get_page (PAL_USER);
+
+	if (kva == NULL) {
+		lock_acquire (&frame_lock);
+		frame = vm_evict_frame ();
+		lock_release (&frame_lock);
+		if (frame == NULL)
+			return NULL;
+	} else {
+		frame = frame_alloc (kva);
+		if (frame == NULL)
+			return NULL;
+	}
 
 	ASSERT (frame != NULL);
-	ASSERT (frame->page == NULL);
+	ASSERT (frame->ref_cnt == 0);
 	return frame;
 }
 
+/* 고정한 FRAME을 푼다. */
+static void
+vm_unpin_frame (struct frame *frame) {
+	lock_acquire (&frame_lock);
+	ASSERT (frame->pin_cnt > 0);
+	frame->pin_cnt--;
+	lock_release (&frame_lock);
+}
+
+/* PAGE를 프레임에 올리고 고정한다. 이미 올라와 있으면 고정만 한다.
+   WRITE면 커널이 매핑을 거치지 않고 쓰므로 나눠 쓰던 프레임은 먼저
+   복사해 둔다. 읽기만 하는 영 페이지는 움직이지 않으므로 그대로 둔다. */
+static bool
+vm_pin_page (struct page *page, bool write) {
+	for (;;) {
+		lock_acquire (&frame_lock);
+		if (page->frame == NULL && page->zero && !write) {
+			lock_release (&frame_lock);
+			return true;
+		}
+		if (page->frame == NULL) {
+			lock_release (&frame_lock);
+			return vm_claim_frame (page);
+		}
+		if (!write || page->frame->ref_cnt == 1) {
+			page->frame->pin_cnt++;
+			lock_release (&frame_lock);
+			return true;
+		}
+		lock_release (&frame_lock);
+		if (!vm_handle_wp (page))
+			return false;
+	}
+}
+
+/* RSP가 스택 포인터일 때 ADDR에 접근하는 것이 스택을 키우는
+   접근인가? push는 rsp보다 8바이트 아래를 먼저 건드린다. */
+bool
+vm_stack_access (const void *addr, uintptr_t rsp) {
+	uintptr_t va = (uintptr_t) addr;
+
+	return va >= rsp - 8 && va < USER_STACK && va >= USER_STACK - STACK_MAX;
+}
+
 /* Growing the stack. */
 // 스택을 키웁니다.
 static void
-vm_stack_growth (void *addr UNUSED) {
+vm_stack_growth (void *addr) {
+	vm_alloc_page (VM_ANON, pg_round_down (addr), true);
+}
+
+/* PAGE가 아직 쓰이지 않아 0으로 채워질 익명 페이지인가? */
+static bool
+page_zero_fill (struct page *page) {
+	return VM_TYPE (page->operations->type) == VM_UNINIT
+		&& VM_TYPE (page->uninit.type) == VM_ANON
+		&& page->uninit.init == NULL;
+}
+
+/* 0으로 채워질 PAGE의 읽기 폴트. 프레임을 받지 않고 공유 영 페이지를
+   읽기 전용으로 매핑한다. 쓰기 폴트는 vm_handle_wp()로 간다. */
+static bool
+vm_map_zero (struct page *page) {
+	if (!pml4_set_page (page->owner->pml4, page->va, zero_kva, false))
+		return false;
+
+	lock_acquire (&frame_lock);
+	page->zero = true;
+	zero_map_cnt++;
+	lock_release (&frame_lock);
+	return true;
+}
+
+/* PAGE를 프레임 FRAME에 WRITABLE로 다시 매핑한다. pml4_set_page()는
+   TLB를 비우지 않으므로 먼저 매핑을 지운다. frame_lock을 쥔 채로
+   불러야 한다. */
+static bool
+vm_remap_page (struct page *page, struct frame *frame, bool writable) {
+	uint64_t *pml4 = page->owner->pml4;
+
+	pml4_clear_page (pml4, page->va);
+	return pml4_set_page (pml4, page->va, frame->kva, writable);
 }
 
 /* Handle the fault on write_protected page */
 // write_protected 페이지에서 오류를 처리합니다.
+/* copy-on-write. 쓰기 가능한 PAGE가 fork 뒤 나눠 쓰는 프레임에 읽기
+   전용으로 매핑되어 있다. 다른 페이지가 모두 떠났으면 그 프레임을 그냥
+   쓰기 가능하게 다시 매핑하고, 아니면 새 프레임에 복사해 옮긴다.
+   복사하는 동안 원래 프레임은 고정해 둔다. */
 static bool
-vm_handle_wp (struct page *page UNUSED) {
+vm_handle_wp (struct page *page) {
+	struct frame *old, *new;
+	bool free_old = false;
+	bool success;
+
+	lock_acquire (&frame_lock);
+	old = page->frame;
+	if (old == NULL) {
+		/* 영 페이지에 매핑되어 있거나 그 사이 내보내졌다.
+		   새로 올리면 혼자 쓰는 프레임이다. */
+		lock_release (&frame_lock);
+		return vm_do_claim_page (page);
+	}
+	if (old->ref_cnt == 1) {
+		success = vm_remap_page (page, old, page->writable);
+		cow_reuse_cnt++;
+		lock_release (&frame_lock);
+		return success;
+	}
+	old->pin_cnt++;
+	lock_release (&frame_lock);
+
+	new = vm_get_frame ();
+	if (new != NULL)
+		memcpy (new->kva, old->kva, PGSIZE);
+
+	lock_acquire (&frame_lock);
+	old->pin_cnt--;
+	if (new == NULL) {
+		lock_release (&frame_lock);
+		return false;
+	}
+	vm_unmap_page (page);
+	frame_unlink (old, page);
+	if (old->ref_cnt == 0) {
+		/* 복사하는 동안 다른 페이지가 모두 떠났다. */
+		frame_table_remove (old);
+		free_old = true;
+	}
+	frame_link (new, page);
+	success = pml4_set_page (page->owner->pml4, page->va, new->kva,
+			page->writable);
+	cow_copy_cnt++;
+	lock_release (&frame_lock);
+
+	vm_unpin_frame (new);
+	if (free_old) {
+		palloc_free_page (old->kva);
+		free (old);
+	}
+	return success;
 }
 
 /* Return true on success */
 // 성공 시 true를 반환합니다.
+/* 커널 모드 폴트는 시스템 콜이 유저 버퍼를 건드린 경우이므로 스택
+   확장 판단에 시스템 콜에 들어올 때 저장해 둔 유저 rsp를 쓴다. */
 bool
-vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
-		bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
-	struct supplemental_page_table *spt UNUSED = &thread_current ()->spt;
-	struct page *page = NULL;
-	/* TODO: Validate the fault */
-	// 오류를 검증하세요
-	/* TODO: Your code goes here */
-	// 코드를 여기에 적으세요
+vm_try_handle_fault (struct intr_frame *f, void *addr,
+		bool user, bool write, bool not_present) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct page *page;
+
+	if (addr == NULL || !is_user_vaddr (addr) || spt->pages.buckets == NULL)
+		return false;
+
+	page = spt_find_page (spt, addr);
+	if (page == NULL) {
+		uintptr_t rsp = user ? f->rsp : thread_current ()->user_rsp;
+
+		if (!not_present || !vm_stack_access (addr, rsp))
+			return false;
+		vm_stack_growth (addr);
+		page = spt_find_page (spt, addr);
+		if (page == NULL)
+			return false;
+	}
+	if (write && !page->writable)
+		return false;
+	if (!not_present)
+		return vm_handle_wp (page);
+	if (!write && page_zero_fill (page))
+		return vm_map_zero (page);
 
 	return vm_do_claim_page (page);
 }
 
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
-// 페이지를 비웁니다. 
+// 페이지를 비웁니다.
 // ※ 해당 함수는 수정하지 마세요! ※
 void
 vm_dealloc_page (struct page *page) {
@@ -175,14 +688,60 @@ vm_dealloc_page (struct page *page) {
 	free (page);
 }
 
+/* PAGE를 해제한다. 프레임이 있으면 먼저 테이블에서 빼서 clock이 다시
+   고르지 못하게 한 뒤 destroy가 내용을 정리하고 매핑을 지우게 하고,
+   그다음 프레임을 돌려준다. 다른 페이지도 쓰는 프레임이면 매핑만
+   지우고 rmap에서 빠진다. 내보내는 중이면 끝날 때까지 기다린다.
+   영 페이지 매핑은 pml4_destroy()가 영 페이지를 해제하지 않도록
+   여기서 지운다. */
+static void
+vm_free_page (struct page *page) {
+	struct frame *frame;
+
+	lock_acquire (&frame_lock);
+	if (page->zero) {
+		vm_unmap_page (page);
+		page->zero = false;
+	}
+	frame = page->frame;
+	if (frame != NULL && frame->ref_cnt > 1) {
+		vm_unmap_page (page);
+		frame_unlink (frame, page);
+		frame = NULL;
+	} else if (frame != NULL)
+		frame_table_remove (frame);
+	lock_release (&frame_lock);
+
+	vm_dealloc_page (page);
+	if (frame != NULL) {
+		palloc_free_page (frame->kva);
+		free (frame);
+	}
+}
+
+/* PAGE의 매핑을 지우고, 지우기 직전에 더러웠는지를 반환한다.
+   매핑을 지운 뒤에는 유저가 더 쓸 수 없으므로 swap_out과 destroy는
+   이것을 부른 다음 내용을 내보낸다. */
+bool
+vm_unmap_page (struct page *page) {
+	uint64_t *pml4 = page->owner->pml4;
+	bool dirty;
+
+	if (pml4 == NULL)
+		return false;
+	dirty = pml4_is_dirty (pml4, page->va);
+	pml4_clear_page (pml4, page->va);
+	return dirty;
+}
+
 /* Claim the page that allocate on VA. */
 // VA로 할당된 페이지를 선언합니다.
 bool
-vm_claim_page (void *va UNUSED) {
-	struct page *page = NULL;
-	/* TODO: Fill this function */
-	// 기능을 구현하세요.
+vm_claim_page (void *va) {
+	struct page *page = spt_find_page (&thread_current ()->spt, va);
 
+	if (page == NULL)
+		return false;
 	return vm_do_claim_page (page);
 }
 
@@ -190,36 +749,424 @@ vm_claim_page (void *va UNUSED) {
 // PAGE를 선언하고 mmu를 설정하세요.
 static bool
 vm_do_claim_page (struct page *page) {
-	struct frame *frame = vm_get_frame ();
+	if (!vm_claim_frame (page))
+		return false;
+	vm_unpin_frame (page->frame);
+	return true;
+}
+
+/* PAGE가 텍스트 캐시에 들어갈 수 있는 읽기 전용 파일 페이지면 그
+   파일 정보를 돌려주고 inode를 *INODE에 넣는다. 아니면 NULL. */
+static struct file_page *
+page_text_key (struct page *page, struct inode **inode) {
+	struct file_page *info;
+
+	if (page->writable || page_get_type (page) != VM_FILE)
+		return NULL;
+	info = page_file_info (page);
+	*inode = file_get_inode (info->file);
+	return info;
+}
+
+/* 텍스트 캐시에서 INODE의 OFS 페이지를 담은 프레임을 찾는다.
+   text_lock을 쥔 채로 불러야 한다. */
+static struct frame *
+text_find (struct inode *inode, off_t ofs) {
+	struct frame key;
+	struct hash_elem *e;
+
+	key.text_inode = inode;
+	key.text_ofs = ofs;
+	e = hash_find (&text_cache, &key.text_elem);
+	return e != NULL ? hash_entry (e, struct frame, text_elem) : NULL;
+}
+
+/* 텍스트 캐시에서 PAGE와 같은 내용을 담은 프레임을 찾아 PAGE를 읽기
+   전용으로 매핑하고 프레임을 고정한다. 캐시에 없으면 false. */
+static bool
+vm_map_text (struct page *page) {
+	struct file_page *info;
+	struct inode *inode;
+	struct frame *frame;
+
+	info = page_text_key (page, &inode);
+	if (info == NULL)
+		return false;
+
+	lock_acquire (&frame_lock);
+	lock_acquire (&text_lock);
+	frame = text_find (inode, info->ofs);
+	lock_release (&text_lock);
+	if (frame == NULL || page->frame != NULL
+			|| frame_page (frame)->file.read_bytes != info->read_bytes
+			|| !pml4_set_page (page->owner->pml4, page->va, frame->kva, false)) {
+		lock_release (&frame_lock);
+		return false;
+	}
+	if (VM_TYPE (page->operations->type) == VM_UNINIT)
+		file_backed_adopt (page);
+	frame_link (frame, page);
+	frame->pin_cnt++;
+	text_share_cnt++;
+	lock_release (&frame_lock);
+	return true;
+}
+
+/* 읽기 전용 파일 페이지 PAGE의 내용을 막 채운 프레임 FRAME을 텍스트
+   캐시에 넣는다. 채우기 시작할 때의 세대 GEN 뒤로 무효화가 있었거나
+   같은 키의 프레임이 이미 있으면 넣지 않는다. */
+static void
+text_insert (struct page *page, struct frame *frame, unsigned gen) {
+	struct file_page *info;
+	struct inode *inode;
+
+	info = page_text_key (page, &inode);
+	if (info == NULL)
+		return;
+
+	lock_acquire (&frame_lock);
+	lock_acquire (&text_lock);
+	if (gen == text_gen && page->frame == frame && frame->text_inode == NULL) {
+		frame->text_inode = inode;
+		frame->text_ofs = info->ofs;
+		if (hash_insert (&text_cache, &frame->text_elem) == NULL)
+			text_cnt++;
+		else
+			frame->text_inode = NULL;
+	}
+	lock_release (&text_lock);
+	lock_release (&frame_lock);
+}
+
+/* INODE의 [OFFSET, OFFSET + SIZE)에 쓴 뒤나 INODE를 지울 때 불린다.
+   그 범위의 프레임을 텍스트 캐시에서 빼서 뒤따르는 폴트가 새 내용을
+   읽게 한다. 이미 매핑한 페이지는 옛 내용을 계속 본다.
+   vm_init() 전(파일 시스템 포맷)에는 할 일이 없다. */
+void
+vm_text_invalidate (struct inode *inode, off_t offset, off_t size) {
+	off_t ofs;
+
+	if (text_cache.buckets == NULL)
+		return;
+
+	lock_acquire (&text_lock);
+	text_gen++;
+	if (text_cnt > 0)
+		for (ofs = ROUND_DOWN (offset, PGSIZE); ofs < offset + size;
+				ofs += PGSIZE) {
+			struct frame *frame = text_find (inode, ofs);
+
+			if (frame != NULL)
+				text_remove (frame);
+		}
+	lock_release (&text_lock);
+}
+
+/* PAGE를 새 프레임에 올리고 PAGE의 주인 페이지 테이블에 매핑한다.
+   내용을 채우는 동안 내보내지지 않도록 프레임은 고정된 채로 돌려준다.
+   읽기 전용 파일 페이지는 텍스트 캐시에 같은 내용이 있으면 그
+   프레임을 나눠 쓴다. */
+static bool
+vm_claim_frame (struct page *page) {
+	struct frame *frame;
+
+	if (vm_map_text (page))
+		return true;
+	frame = vm_get_frame ();
+	if (frame == NULL)
+		return false;
+	return vm_map_frame (page, frame);
+}
+
+/* 스왑 미리 읽기. 유저 풀에 빈 프레임이 있을 때만 PAGE를 올려 매핑하고
+   내보내기는 하지 않는다. 올린 페이지는 accessed 비트가 꺼져 있으므로
+   쓰이지 않으면 clock이 먼저 내보낸다. */
+bool
+vm_prefetch_page (struct page *page) {
+	void *kva = palloc_get_page (PAL_USER);
+	struct frame *frame;
+
+	if (kva == NULL || (frame = frame_alloc (kva)) == NULL)
+		return false;
+	if (!vm_map_frame (page, frame))
+		return false;
+	vm_unpin_frame (page->frame);
+	return true;
+}
+
+/* 고정된 새 프레임 FRAME에 PAGE를 채우고 매핑한다. 실패하면 FRAME을
+   돌려준다. */
+static bool
+vm_map_frame (struct page *page, struct frame *frame) {
+	unsigned gen;
 
 	/* Set links */
-	frame->page = page;
-	page->frame = frame;
+	lock_acquire (&frame_lock);
+	if (page->frame != NULL) {
+		/* 내보내기가 매핑을 지운 직후에 폴트가 났다가 그 사이 다시
+		   올라온 경우. 올라와 있는 프레임을 대신 고정한다. */
+		page->frame->pin_cnt++;
+		frame_table_remove (frame);
+		lock_release (&frame_lock);
+		palloc_free_page (frame->kva);
+		free (frame);
+		return true;
+	}
+	frame_link (frame, page);
+	page_in_cnt++;
+	lock_acquire (&text_lock);
+	gen = text_gen;
+	lock_release (&text_lock);
+	if (page->zero) {
+		/* pml4_set_page()는 TLB를 비우지 않으므로 영 페이지 매핑을
+		   먼저 지운다. */
+		vm_unmap_page (page);
+		page->zero = false;
+		zero_break_cnt++;
+	}
+	lock_release (&frame_lock);
 
-	/* TODO: Insert page table entry to map page's VA to frame's PA. */
-	// 페이지의 VA를 프레임의 PA에 매핑하기 위해 페이지 테이블 항목을 삽입합니다.
+	/* 내용을 먼저 채우고 매핑해야 유저가 채우는 중인 페이지를 보지 않는다. */
+	if (swap_in (page, frame->kva)
+			&& pml4_set_page (page->owner->pml4, page->va, frame->kva,
+				page->writable)) {
+		text_insert (page, frame, gen);
+		return true;
+	}
 
-	return swap_in (page, frame->kva);
+	lock_acquire (&frame_lock);
+	frame_unlink (frame, page);
+	frame_table_remove (frame);
+	lock_release (&frame_lock);
+	palloc_free_page (frame->kva);
+	free (frame);
+	return false;
+}
+
+/* 유저 버퍼 [UADDR, UADDR + SIZE)가 걸친 페이지를 모두 프레임에 올리고
+   고정한다. 파일시스템 락을 쥔 채 유저 버퍼에서 폴트가 나면 같은 파일을
+   되돌려 쓰려는 내보내기와 서로 기다리게 되므로, read와 write는 버퍼를
+   먼저 고정해 둔다. WRITE면 모든 페이지가 쓰기 가능해야 한다.
+   실패하면 고정한 페이지를 다시 풀고 false. */
+bool
+vm_pin_buffer (const void *uaddr, size_t size, bool write) {
+	struct thread *t = thread_current ();
+	uint8_t *start = pg_round_down (uaddr);
+	uint8_t *end = (uint8_t *) uaddr + size;
+	uint8_t *p;
+
+	for (p = start; p < end; p += PGSIZE) {
+		struct page *page = spt_find_page (&t->spt, p);
+
+		if (page == NULL && vm_stack_access (p, t->user_rsp)) {
+			vm_stack_growth (p);
+			page = spt_find_page (&t->spt, p);
+		}
+		if (page == NULL || (write && !page->writable)
+				|| !vm_pin_page (page, write)) {
+			vm_unpin_buffer (start, p - start);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* vm_pin_buffer()로 고정한 [UADDR, UADDR + SIZE)를 푼다. */
+void
+vm_unpin_buffer (const void *uaddr, size_t size) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	uint8_t *end = (uint8_t *) uaddr + size;
+	uint8_t *p;
+
+	for (p = pg_round_down (uaddr); p < end; p += PGSIZE) {
+		struct page *page = spt_find_page (spt, p);
+
+		if (page != NULL && page->frame != NULL)
+			vm_unpin_frame (page->frame);
+	}
 }
 
 /* Initialize new supplemental page table */
 // 새로운 보충 페이지 테이블을 초기화합니다.
 void
-supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
+supplemental_page_table_init (struct supplemental_page_table *spt) {
+	hash_init (&spt->pages, page_hash, page_less, NULL);
+}
+
+/* 부모의 페이지 SRC를 자식 페이지 DST와 나눠 쓴다.
+   프레임에 있으면 두 페이지를 같은 프레임에 읽기 전용으로 매핑하고,
+   스왑에 있는 익명 페이지는 슬롯을 나눠 갖는다. 쓰기 가능한 익명
+   페이지는 먼저 쓰는 쪽이 vm_handle_wp()에서 자기 프레임을 받는다
+   (copy-on-write). */
+static bool
+page_share (struct page *dst, struct page *src) {
+	struct frame *frame;
+	bool success = true;
+
+	lock_acquire (&frame_lock);
+	frame = src->frame;
+	if (frame != NULL) {
+		success = pml4_set_page (dst->owner->pml4, dst->va, frame->kva, false);
+		if (success) {
+			frame_link (frame, dst);
+			if (src->writable)
+				vm_remap_page (src, frame, false);
+		}
+	} else if (VM_TYPE (src->operations->type) == VM_ANON)
+		anon_share_slot (dst, src);
+	lock_release (&frame_lock);
+	return success;
+}
+
+/* 부모의 페이지 SRC를 현재 스레드(자식)의 SPT에 복제한다.
+   아직 올라오지 않은 페이지는 지연 로딩 정보만 복제하고, 초기화된
+   익명 페이지와 읽기 전용 파일 페이지는 프레임을 나눠 쓴다. 쓰기
+   가능한 파일 페이지는 되돌려 쓸 때 어느 쪽 내용인지 가릴 수 없으므로
+   부모 쪽을 올려 고정한 채 자식 프레임에 내용을 복사한다. */
+static bool
+page_copy (struct page *src) {
+	enum vm_type type = VM_TYPE (src->operations->type);
+	struct page *dst;
+	bool success;
+
+	if (type == VM_UNINIT) {
+		/* 이 트리에서 uninit 페이지의 AUX는 NULL이거나
+		   malloc한 struct file_page다. */
+		struct file_page *aux = src->uninit.aux;
+
+		if (aux != NULL && (aux = file_page_dup (aux)) == NULL)
+			return false;
+		if (!vm_alloc_page_with_initializer (src->uninit.type, src->va,
+					src->writable, src->uninit.init, aux)) {
+			file_page_free (aux);
+			return false;
+		}
+		return true;
+	}
+
+	if (type == VM_ANON || (type == VM_FILE && !src->writable)) {
+		dst = malloc (sizeof *dst);
+		if (dst == NULL)
+			return false;
+		*dst = *src;
+		dst->frame = NULL;
+		dst->owner = thread_current ();
+		if (type == VM_ANON) {
+			dst->anon.slot = SWAP_NONE;
+			dst->anon.readahead = false;
+		} else
+			dst->file.file = file_dup2 (src->file.file);
+		if (!spt_insert_page (&dst->owner->spt, dst)) {
+			if (type == VM_FILE)
+				file_close (dst->file.file);
+			free (dst);
+			return false;
+		}
+		return page_share (dst, src);
+	}
+
+	if (!vm_alloc_page (type, src->va, src->writable))
+		return false;
+	dst = spt_find_page (&thread_current ()->spt, src->va);
+	if (!vm_pin_page (src, false))
+		return false;
+	success = vm_claim_frame (dst);
+	if (success) {
+		memcpy (dst->frame->kva, src->frame->kva, PGSIZE);
+		if (type == VM_FILE) {
+			dst->file = src->file;
+			dst->file.file = file_dup2 (src->file.file);
+			if (pml4_is_dirty (src->owner->pml4, src->va))
+				pml4_set_dirty (dst->owner->pml4, dst->va, true);
+		}
+		vm_unpin_frame (dst->frame);
+	}
+	vm_unpin_frame (src->frame);
+	return success;
 }
 
 /* Copy supplemental page table from src to dst */
 // src에서 dst로 보충 페이지 테이블 복사합니다.
+/* fork하는 자식 스레드에서 불리며 DST는 자식의 SPT다. */
 bool
-supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
-		struct supplemental_page_table *src UNUSED) {
+supplemental_page_table_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src) {
+	struct hash_iterator i;
+
+	ASSERT (dst == &thread_current ()->spt);
+
+	hash_first (&i, &src->pages);
+	while (hash_next (&i))
+		if (!page_copy (hash_entry (hash_cur (&i), struct page, spt_elem)))
+			return false;
+	return true;
 }
 
 /* Free the resource hold by the supplemental page table */
 // 보충 페이지 테이블에서 리소스 보류를 해제합니다.
+/* 수정된 파일 페이지는 되돌려 쓴다. 두 번 불러도 되고, SPT를 만든 적
+   없는 커널 스레드에서 불려도 된다. */
+void
+supplemental_page_table_kill (struct supplemental_page_table *spt) {
+	if (spt->pages.buckets == NULL)
+		return;
+	hash_destroy (&spt->pages, page_destructor);
+	spt->pages.buckets = NULL;
+}
+
+/* SPT 해시 함수. 페이지 주소가 키다. */
+static uint64_t
+page_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct page *page = hash_entry (e, struct page, spt_elem);
+
+	return hash_bytes (&page->va, sizeof page->va);
+}
+
+/* SPT 비교 함수. */
+static bool
+page_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct page, spt_elem)->va
+		< hash_entry (b, struct page, spt_elem)->va;
+}
+
+/* supplemental_page_table_kill()의 원소 해제 함수. */
+static void
+page_destructor (struct hash_elem *e, void *aux UNUSED) {
+	vm_free_page (hash_entry (e, struct page, spt_elem));
+}
+
+/* 텍스트 캐시 해시 함수. (inode, 오프셋)이 키다. */
+static uint64_t
+text_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct frame *frame = hash_entry (e, struct frame, text_elem);
+
+	return hash_bytes (&frame->text_inode, sizeof frame->text_inode)
+		^ hash_int (frame->text_ofs);
+}
+
+/* 텍스트 캐시 비교 함수. */
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct frame *a = hash_entry (a_, struct frame, text_elem);
+	const struct frame *b = hash_entry (b_, struct frame, text_elem);
+
+	if (a->text_inode != b->text_inode)
+		return a->text_inode < b->text_inode;
+	return a->text_ofs < b->text_ofs;
+}
+
+/* 프레임 테이블 통계를 출력한다. */
 void
-supplemental_page_table_kill (struct supplemental_page_table *spt UNUSED) {
-	/* TODO: Destroy all the supplemental_page_table hold by thread and
-	 * TODO: writeback all the modified contents to the storage. */
-	// 스레드가 보유한 supplemental_page_table을 모두 파괴하고 수정된 내용을 모두 저장소에 다시 쓰게 구현하세요.
+vm_print_stats (void) {
+	printf ("VM: %zu frames, %lld page-ins, %lld evictions (%lld clean)\n",
+			frame_cnt, page_in_cnt, evict_cnt, evict_clean_cnt);
+	printf ("COW: %lld copies, %lld reused without copy\n",
+			cow_copy_cnt, cow_reuse_cnt);
+	printf ("Zero page: %lld read faults mapped, %lld later written\n",
+			zero_map_cnt, zero_break_cnt);
+	printf ("Text: %zu frames cached, %lld faults served from the cache\n",
+			text_cnt, text_share_cnt);
+	anon_print_stats ();
 }